@@ -0,0 +1,117 @@
+/*
+ * File: Compiler.h
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  Compilation of students' files.
+ *  The compiler, its flags and an optional first-pass syntax check are taken from the configuration file.
+ *  Submissions that start with a block of common system includes (stdio.h, stdlib.h, ...) are compiled
+ *  with a precompiled header of exactly these includes. Every distinct block is precompiled once per run.
+ *  The link is the largest fixed cost of a small submission, so a faster linker is used when there is one.
+ */
+
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include "GraduateStudents.h"
+
+// Maximal number of distinct include blocks that get a precompiled header.
+#define PCH_CACHE 16
+
+/*
+ * Pch_Entry - Precompiled header of one block of includes.
+ *  - key: Includes of the block separated by spaces, in the order they appear.
+ *  - header: Path to the generated header, the .gch file lies next to it.
+ *  - ok: 1 if the header was precompiled successfully, 0 otherwise.
+ */
+typedef struct
+{
+    char key[MAX_LEN];
+    char header[MAX_LEN];
+    int ok;
+} Pch_Entry;
+
+/*
+ * Compiler - Compilation settings and the cache of precompiled headers.
+ *  - compiler: Compiler command (COMPILER=, default "gcc").
+ *  - cflags: Extra flags separated by spaces (CFLAGS=, default none).
+ *  - syntax_check: Command of the first-pass syntax check, the file is appended to it (SYNTAX_CHECK=, default none).
+ *  - pch_headers: Headers allowed in a precompiled header (PCH_HEADERS=).
+ *  - use_pch: 1 to use precompiled headers (PCH=1/0, default 1).
+ *  - pch_min_headers: Smallest block of includes that gets a precompiled header (PCH_MIN_HEADERS=, default 3).
+ *    Loading a precompiled header costs about as much as parsing stdio.h alone, so small blocks are compiled as is.
+ *  - pch_dir: Temporary directory with the precompiled headers.
+ *  - linker: Linker given to the compiler with -fuse-ld= (LINKER=, default "auto": gold if the compiler can use it,
+ *    "default" for the compiler's own).
+ *  - ld_flag: The -fuse-ld= flag chosen by compiler_init, empty for the compiler's own linker.
+ */
+typedef struct Compiler
+{
+    char compiler[MAX_LEN];
+    char cflags[MAX_LEN];
+    char syntax_check[MAX_LEN];
+    char pch_headers[MAX_LEN];
+    int use_pch;
+    int pch_min_headers;
+    char pch_dir[MAX_LEN];
+    char linker[MAX_LEN];
+    char ld_flag[MAX_LEN + 16];
+    Pch_Entry pch[PCH_CACHE];
+    int n_pch;
+} Compiler;
+
+/*
+ * compiler_defaults - Fill the compiler settings with default values.
+ *
+ * Parameters:
+ *   Compiler* cc - Settings to fill.
+ */
+void compiler_defaults(Compiler *cc);
+
+/*
+ * compiler_option - Apply one "KEY=VALUE" setting from the configuration file.
+ *
+ * Parameters:
+ *   Compiler* cc - Settings to change.
+ *   const char* key - Name of the setting.
+ *   const char* value - Value of the setting.
+ *
+ * Returns:
+ *   0 - The setting belongs to the compiler.
+ *   GEN_ERROR - Unknown setting or too long value.
+ */
+int compiler_option(Compiler *cc, const char *key, const char *value);
+
+/*
+ * compiler_init - Prepare the directory for precompiled headers and choose the linker.
+ * If the directory cannot be created, precompiled headers are turned off.
+ *
+ * Parameters:
+ *   Compiler* cc - Compiler settings.
+ */
+void compiler_init(Compiler *cc);
+
+/*
+ * compile_file - Compile the file located at the given path and generate the executable at the specified path.
+ * Runs the syntax check first if one is configured. Exits if system calls fail.
+ *
+ * Parameters:
+ *   Compiler* cc - Compiler settings.
+ *   char* path - Path to the source file to be compiled.
+ *   char* path_exe - Path to the generated executable file.
+ *
+ * Returns:
+ *   0 - Success.
+ *   COMPL_ERROR - Compilation error.
+ */
+int compile_file(Compiler *cc, char *path, char *path_exe);
+
+/*
+ * compiler_destroy - Delete the precompiled headers and their directory.
+ *
+ * Parameters:
+ *   Compiler* cc - Compiler settings.
+ */
+void compiler_destroy(Compiler *cc);
+
+#endif // COMPILER_H
@@ -22,15 +22,16 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <signal.h>
+#include "GraduateStudents.h"
+#include "Compiler.h"
+#include "Watch.h"
+#include "Results.h"
+#include "Journal.h"
+#include "Shard.h"
 
-#define GEN_ERROR -1
-#define SAME 1
-#define DIFF 2
-#define SIMILAR 3
-#define COMPL_ERROR 4
-#define NO_C_FILE 5
-#define TIME_OUT 6
-#define MAX_LEN 151
+
+// Output of the student's program. Workers that share a directory use one file each.
+char output_file[MAX_LEN] = "output.txt";
 
 
 /*
@@ -85,18 +86,28 @@ void add_to_path(char *result, const char *path_b, char *path_f)
 }
 
 /*
- * open_input_output - Open "output.txt" for output, the input file for input, and perform I/O redirection.
- * Redirects STD_OUT to "output.txt," STD_IN to the input file, and STD_ERROR to the provided error file descriptor.
+ * open_input_output - Open output_file ("output.txt") for output, the input file for input, and perform I/O redirection.
+ * Redirects STD_OUT to output_file, STD_IN to the input file, and STD_ERROR to the provided error file descriptor.
  * 
  * Parameters:
- *   int* ios - Array to store the previous STD_IN, STD_OUT, and STD_ERROR file descriptors.
+ *   int* ios - Array to store copies of the previous STD_OUT, STD_IN, and STD_ERROR file descriptors.
  *   char* input - Path to the input file.
  *   int errors - File descriptor of the "errors.txt" file.
  */
 void open_input_output(int *ios, char *input, int errors)
 {
-    /// Try to open "output.txt" with create, read, and write permissions.
-    int fd_output = open("output.txt", O_WRONLY | O_RDONLY | O_CREAT, 0644);
+    // Keep copies of the current descriptors to restore them later.
+    ios[0] = dup(STDOUT_FILENO);
+    ios[1] = dup(STDIN_FILENO);
+    ios[2] = dup(STDERR_FILENO);
+    if (ios[0] < 0 || ios[1] < 0 || ios[2] < 0)
+    {
+        perror("Error in: dup");
+        exit(GEN_ERROR);
+    }
+
+    /// Try to open the output file for writing, an old file left by a crashed run is truncated.
+    int fd_output = open(output_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
     if (fd_output < 0)
     {
         perror("Error in: open");
@@ -118,7 +129,7 @@ void open_input_output(int *ios, char *input, int errors)
         exit(GEN_ERROR);
     }
 
-    // Perform I/O redirection: Redirect output to "output.txt."
+    // Perform I/O redirection: Redirect output to the output file.
     int fd_out = dup2(fd_output, STDOUT_FILENO);
     if (fd_out < 0)
     {
@@ -135,11 +146,6 @@ void open_input_output(int *ios, char *input, int errors)
         exit(GEN_ERROR);
     }
     close(fd_input);
-
-    // Save the previous file descriptors in the ios array.
-    ios[0] = fd_out;
-    ios[1] = fd_in;
-    ios[2] = fd_err;
 }
 
 /*
@@ -218,56 +224,7 @@ int execute_file(char *path)
 }
 
 /*
- * compile_file - Compile the file located at the given path and generate the executable at the specified path.
- * Exits if system calls fail.
- * 
- * Parameters:
- *   char* path - Path to the source file to be compiled.
- *   char* path_exe - Path to the generated executable file.
- * 
- * Returns:
- *   0 - Success.
- *   COMPL_ERROR - Compilation error.
- */
-int compile_file(char *path, char *path_exe)
-{   
-    // Create a new process to compile the file.
-    pid_t pid;
-    int status;
-    pid = fork();
-
-    // Child process calls exec with gcc.
-    if (pid == 0)
-    {
-        execlp("gcc", "gcc", path, "-o", path_exe, NULL);
-        perror("Error in: execlp");
-        exit(GEN_ERROR);
-    }
-    else if (pid < 0)
-    {
-        perror("Error in: fork");
-    }
-    else
-    {   
-        // Parent process waits for the child to finish.
-        if (waitpid(pid, &status, 0) == GEN_ERROR)
-        {
-            perror("Error in: waitpid");
-            exit(GEN_ERROR);
-        }
-        // Check the status returned by the child process.
-        if (WIFEXITED(status))
-        {
-            if (WEXITSTATUS(status) != 0) // If status isn't 0, then it's a compilation error.
-                return COMPL_ERROR;
-
-            return 0;
-        }
-    }
-}
-
-/*
- * check_output - Run the comp.out executable to compare the content of the current "output.txt" file
+ * check_output - Run the comp.out executable to compare the content of the current output file
  * with the content of the specified "correct_output" file. Exits with -1 when an error occurs.
  * 
  * Parameters:
@@ -287,8 +244,8 @@ int check_output(char *correct_output)
 
     if (pid == 0)
     {
-        // Run the comp.out executable to compare "output.txt" and "correct_output.txt".
-        execlp("./comp.out", "./comp.out", "./output.txt", correct_output, NULL);
+        // Run the comp.out executable to compare the output file and "correct_output.txt".
+        execlp("./comp.out", "./comp.out", output_file, correct_output, NULL);
         perror("Error in: execlp");
         exit(GEN_ERROR);
     }
@@ -318,12 +275,13 @@ int check_output(char *correct_output)
 }
 
 /*
- * return_ios - Restore standard file descriptors (stdin, stdout, stderr) to their original values.
+ * return_ios - Restore standard file descriptors (stdin, stdout, stderr) to their original values
+ * and close the copies made by open_input_output.
  * 
  * Parameters:
- *   int in - Original stdin file descriptor.
- *   int out - Original stdout file descriptor.
- *   int err - Original stderr file descriptor.
+ *   int in - Copy of the original stdin file descriptor.
+ *   int out - Copy of the original stdout file descriptor.
+ *   int err - Copy of the original stderr file descriptor.
  */
 void return_ios(int in, int out, int err)
 {
@@ -332,45 +290,40 @@ void return_ios(int in, int out, int err)
         perror("Error in: dup2");
         exit(GEN_ERROR);
     }
-    if (dup2(in, STDOUT_FILENO) < 0)
+    if (dup2(in, STDIN_FILENO) < 0)
     {
         perror("Error in: dup2");
         exit(GEN_ERROR);
     }
-    if (dup2(err, STDOUT_FILENO) < 0)
+    if (dup2(err, STDERR_FILENO) < 0)
     {
         perror("Error in: dup2");
         exit(GEN_ERROR);
     }
-
+    close(out);
+    close(in);
+    close(err);
 }
 
 
 
 /*
- * handle_student - Find a C file in the student's directory, compile it, execute it, and compare
- * the output with the given correct output.
- * 
+ * find_c_file - Find the C file in the student's directory.
+ *
  * Parameters:
  *   const char* path - Path to the student's directory.
- *   int errors - File descriptor of errors.txt.
- *   char* input - Path to the input file.
- *   char* output - Path to the output file.
- * 
- * Return Values:
- *   GEN_ERROR - Error in system calls.
- *   SAME - Output is correct.
- *   DIFF - Output is different.
- *   SIMILAR - Output is similar.
- *   COMPL_ERROR - Compile error.
- *   NO_C_FILE - No C file found in the directory.
- *   TIME_OUT - Timeout.
+ *   char* path_to_file - Buffer of MAX_LEN characters for the path to the C file.
+ *
+ * Returns:
+ *   1 - A C file was found.
+ *   0 - There is no C file in the directory.
+ *   GEN_ERROR - The directory cannot be opened.
  */
-int handle_student(const char *path, int errors, char *input, char *output)
+int find_c_file(const char *path, char *path_to_file)
 {
-
     DIR *dir;
     struct dirent *entry;
+    int found = 0;
 
     // Try to open the directory
     dir = opendir(path);
@@ -380,78 +333,119 @@ int handle_student(const char *path, int errors, char *input, char *output)
         return GEN_ERROR;
     }
 
-    // Open output.txt and perform I/O redirections for input, output, and errors.
-    int count = 0;
-    int result = 0;
-    int fd_ios[3];
-    open_input_output((int *)&fd_ios, input, errors);
-
     // Read directory entries
     while ((entry = readdir(dir)) != NULL)
     {
         // Check if the entry is a regular file with a .c extension
-        if (entry->d_type == DT_REG && strstr(entry->d_name, ".c") != NULL)
+        if (entry->d_type == DT_REG && strstr(entry->d_name, ".c") != NULL && is_C_file(entry->d_name) == 1)
         {
-            // Check if the current entry is a C file.
-            if (is_C_file(entry->d_name) == 1)
-            {
-                count = 1;
-                // Create an absolute path to the C file and the future executable file.
-                char path_to_file[MAX_LEN];
-                add_to_path(path_to_file, path, entry->d_name);
-                char path_exe[MAX_LEN];
-                path_executed(path_to_file, path_exe);
-
-                // Compile the file
-                result = compile_file(path_to_file, path_exe);
-                if (result != 0)
-                    break;
-
-                // Execute the file
-                result = execute_file(path_exe);
-                if (result != 0)
-                    break;
-                ;
-
-                // Delete the executable file
-                delete_file(path_exe);
-
-                // Check the output with the correct output
-                result = check_output(output);
-                break;
-            }
+            // Create an absolute path to the C file.
+            add_to_path(path_to_file, path, entry->d_name);
+            found = 1;
+            break;
         }
     }
 
-    // Return file descriptors to their original states before I/O redirection.
-    return_ios(fd_ios[1], fd_ios[0], fd_ios[2]);
-
     // Close the directory
     if (closedir(dir) < 0)
     {
         perror("Error in: closedir");
         exit(GEN_ERROR);
     }
-    
-    // If count is 0, then there is no C file in the directory.
-    if (!count)
+    return found;
+}
+
+
+/*
+ * grade_c_file - Compile the C file, execute it, and compare its output with the correct output.
+ * Standard file descriptors have to be redirected already.
+ *
+ * Parameters:
+ *   Compiler* cc - Compiler settings.
+ *   char* path_to_file - Path to the C file.
+ *   char* output - Path to the correct output file.
+ *
+ * Returns:
+ *   Same codes as handle_student, except NO_C_FILE.
+ */
+int grade_c_file(Compiler *cc, char *path_to_file, char *output)
+{
+    // Create a path to the future executable file.
+    char path_exe[MAX_LEN];
+    path_executed(path_to_file, path_exe);
+
+    // Compile the file
+    int result = compile_file(cc, path_to_file, path_exe);
+    if (result != 0)
+        return result;
+
+    // Execute the file
+    result = execute_file(path_exe);
+    if (result != 0)
+        return result;
+
+    // Delete the executable file
+    delete_file(path_exe);
+
+    // Check the output with the correct output
+    return check_output(output);
+}
+
+
+/*
+ * handle_student - Find a C file in the student's directory, compile it, execute it, and compare
+ * the output with the given correct output.
+ * 
+ * Parameters:
+ *   const char* path - Path to the student's directory.
+ *   int errors - File descriptor of errors.txt.
+ *   char* input - Path to the input file.
+ *   char* output - Path to the output file.
+ *   Compiler* cc - Compiler settings.
+ * 
+ * Return Values:
+ *   GEN_ERROR - Error in system calls.
+ *   SAME - Output is correct.
+ *   DIFF - Output is different.
+ *   SIMILAR - Output is similar.
+ *   COMPL_ERROR - Compile error.
+ *   NO_C_FILE - No C file found in the directory.
+ *   TIME_OUT - Timeout.
+ */
+int handle_student(const char *path, int errors, char *input, char *output, Compiler *cc)
+{
+    char path_to_file[MAX_LEN];
+    int found = find_c_file(path, path_to_file);
+    if (found == GEN_ERROR)
+        return GEN_ERROR;
+
+    // If there is no C file in the directory.
+    if (!found)
         return NO_C_FILE;
 
+    // Open the output file and perform I/O redirections for input, output, and errors.
+    int fd_ios[3];
+    open_input_output((int *)&fd_ios, input, errors);
+
+    int result = grade_c_file(cc, path_to_file, output);
+
+    // Return file descriptors to their original states before I/O redirection.
+    return_ios(fd_ios[1], fd_ios[0], fd_ios[2]);
+
+    delete_file(output_file);
     return result;
 }
 
 /*
- * graduate_student - Write the student's name, grade, and explanation for the grade
- * in results.csv.
+ * result_line - Build the line of results.csv with the student's name, grade, and explanation for the grade.
  * 
  * Parameters:
  *   int code - The code for student graduation, indicating the error or result of comparing outputs.
- *   char* name - Student's name.
- *   int fd_results - File descriptor of results.csv.
+ *   const char* name - Student's name.
+ *   char* line - Buffer of RESULT_LEN characters for the line.
  */
-int graduate_student(int code, char *name, int fd_results)
+void result_line(int code, const char *name, char *line)
 {
-    char line[MAX_LEN];
     strcpy(line, name);
     strcat(line, ",");
 
@@ -478,35 +472,18 @@ int graduate_student(int code, char *name, int fd_results)
     default:
         break;
     }
-
-    if (write(fd_results, line, strlen(line)) == GEN_ERROR)
-    {
-        perror("Error in: write");
-        close(fd_results);
-        exit(GEN_ERROR);
-    }
 }
 
 
 /*
- * open_files - Attempt to open the "results.csv" file to output results
- * and the "errors.txt" file to save errors.
- * If the `open` function calls fail, the program exits with an error code.
- * 
- * Parameters:
- *   int* results - Pointer to a variable to store the file descriptor of "results.csv".
- *   int* errors - Pointer to a variable to store the file descriptor of "errors.txt".
+ * open_errors - Attempt to open the "errors.txt" file to save errors.
+ * If the `open` function call fails, the program exits with an error code.
+ *
+ * Returns:
+ *   File descriptor of "errors.txt".
  */
-void open_files(int *results, int *errors)
-{   
-
-    /// Try to open "results.csv" with create, write-append permissions.
-    int fd_results = open("results.csv", O_WRONLY | O_CREAT, 0777 | O_APPEND);
-    if (fd_results < 0)
-    {
-        perror("Error in: open");
-        exit(GEN_ERROR);
-    }
+int open_errors()
+{
     // Try to open "errors.txt" with create, read, and write permissions.
     int fd_error = open("errors.txt", O_WRONLY | O_RDONLY | O_CREAT, 0644);
     if (fd_error < 0)
@@ -514,18 +491,22 @@ void open_files(int *results, int *errors)
         perror("Error in: open");
         exit(GEN_ERROR);
     }
-    *results = fd_results;
-    *errors = fd_error;
+    return fd_error;
 }
 
 
 /*
  * handle_students - Iterate through the students' directory, handle each student, and graduate them.
+ * Students found in the journal of an interrupted run keep their verdict and are not graded again.
  * 
  * Parameters:
  *   char conf[][] - Configuration data file.
+ *   Compiler* cc - Compiler settings.
+ *   Results* done - Verdicts loaded from the journal.
+ *   Results* results - Table to fill with the verdicts of all students.
+ *   Journal* journal - Journal to append new verdicts to.
  */
-int handle_students(char conf[][MAX_LEN])
+int handle_students(char conf[][MAX_LEN], Compiler *cc, Results *done, Results *results, Journal *journal)
 {
 
     
@@ -534,9 +515,7 @@ int handle_students(char conf[][MAX_LEN])
     int response = 0;
 
     // Open necessary files.
-    int results;
-    int errors;
-    open_files(&results, &errors);
+    int errors = open_errors();
 
     // Try to open the directory with students.
     if ((pDir = opendir(conf[0])) == NULL)
@@ -548,34 +527,87 @@ int handle_students(char conf[][MAX_LEN])
         // If the current node is a directory and not ".", ".."
         if (pDirent->d_type == DT_DIR && strcmp(pDirent->d_name, ".") != 0 && strcmp(pDirent->d_name, "..") != 0)
         {
+            // The student was graded before the crash.
+            Result *old = results_find(done, pDirent->d_name);
+            if (old != NULL)
+            {
+                results_set(results, pDirent->d_name, old->code);
+                continue;
+            }
+
             // Add the new directory to the path.
             char path_to_file[151];
             add_to_path(path_to_file, conf[0], pDirent->d_name);
 
-            response = handle_student(path_to_file, errors, conf[1], conf[2]);
+            response = handle_student(path_to_file, errors, conf[1], conf[2], cc);
 
-            delete_file("output.txt");
-            
-            // Write the results of the student to results.csv.
-            graduate_student(response, pDirent->d_name, results);
+            // Save the result of the student in the journal and the table of results.csv.
+            journal_append(journal, pDirent->d_name, response);
+            results_set(results, pDirent->d_name, response);
         }
     }
 
     if (closedir(pDir) < 0)
         exit(GEN_ERROR);
+    close(errors);
     return response;
 }
 
 
+/*
+ * grade_all - Grade the whole students' directory once and write results.csv.
+ * Progress is kept in "results.journal", so a crashed run continues where it stopped.
+ * The journal is deleted after results.csv is written.
+ *
+ * Parameters:
+ *   char conf[][] - Configuration data file.
+ *   Compiler* cc - Compiler settings.
+ *
+ * Returns:
+ *   0 - Success.
+ *   GEN_ERROR - The journal or results.csv could not be written.
+ */
+int grade_all(char conf[][MAX_LEN], Compiler *cc)
+{
+    Results done, results;
+    Journal journal;
+    char key[JOURNAL_KEY_LEN];
+
+    results_init(&done);
+    results_init(&results);
+    journal_key(conf, key);
+    int resumed = journal_open(&journal, "results.journal", key, &done);
+    if (resumed == GEN_ERROR)
+        return GEN_ERROR;
+    if (resumed > 0)
+        printf("Resuming: %d students already graded\n", resumed);
+
+    handle_students(conf, cc, &done, &results, &journal);
+
+    // Keep the journal if results.csv could not be written.
+    journal_sync(&journal);
+    int result = results_write(&results, "results.csv");
+    journal_close(&journal, "results.journal", result == 0);
+
+    results_destroy(&done);
+    results_destroy(&results);
+    return result;
+}
+
+
 
 /*
  * read_conf - Read data from a configuration file and store it in a given array.
+ * Lines after the first CONF_LINES lines and characters after the first MAX_LEN - 1 of a line are ignored.
  *
  * Parameters:
  *   const char* file_name - Path to the configuration file.
- *   char conf[][MAX_LEN] - Array to store data from the file.
+ *   char conf[][MAX_LEN] - Array of CONF_LINES lines to store data from the file.
+ *
+ * Returns:
+ *   Number of lines read.
  */
-void read_conf(const char *file_name, char conf[][MAX_LEN])
+int read_conf(const char *file_name, char conf[][MAX_LEN])
 {
     // Try to open the file.
     int fd_conf = open(file_name, O_RDONLY);
@@ -589,10 +621,10 @@ void read_conf(const char *file_name, char conf[][MAX_LEN])
     int x;
     int i = 0, j = 0;
     char buff;
-    while (1)
+    while (i < CONF_LINES)
     {   
         // Try to read the next character.
-        x = read(fd_conf, &conf[i][j], 1);
+        x = read(fd_conf, &buff, 1);
         if (x < 0)
         {
             perror("Error in: read");
@@ -604,21 +636,69 @@ void read_conf(const char *file_name, char conf[][MAX_LEN])
             break;
 
         // If reached the end of a line, then move to the next line in conf[][].
-        if (conf[i][j] == '\n'){
+        if (buff == '\n'){
             conf[i][j] = '\0';  // Null-terminate the string.
             i++;
             j = 0;
         }
-        else{
+        else if (j < MAX_LEN - 1){
+            conf[i][j] = buff;
             j++;
         }
     }
 
+    // The last line may end without a newline.
+    if (i < CONF_LINES && j > 0){
+        conf[i][j] = '\0';
+        i++;
+    }
+
     // Try to close the file.
     if (close(fd_conf) < 0){
         perror("Error in: close");
         exit(GEN_ERROR);
     }
+    return i;
+}
+
+
+/*
+ * read_options - Apply the optional "KEY=VALUE" lines that follow the three paths in the configuration file.
+ * Empty lines are skipped.
+ *
+ * Parameters:
+ *   char conf[][MAX_LEN] - Lines of the configuration file.
+ *   int lines - Number of lines.
+ *   Compiler* cc - Compiler settings.
+ *
+ * Returns:
+ *   -1 (GEN_ERROR) - If a line is not a known setting.
+ *    0 - Otherwise.
+ */
+int read_options(char conf[][MAX_LEN], int lines, Compiler *cc)
+{
+    for (int i = 3; i < lines; i++)
+    {
+        if (conf[i][0] == '\0' || conf[i][0] == '\r')
+            continue;
+
+        // Split the line into key and value.
+        char *value = strchr(conf[i], '=');
+        if (value == NULL)
+        {
+            printf("Wrong setting: %s\n", conf[i]);
+            return GEN_ERROR;
+        }
+        *value = '\0';
+        value++;
+
+        if (compiler_option(cc, conf[i], value) != 0)
+        {
+            printf("Unknown setting: %s\n", conf[i]);
+            return GEN_ERROR;
+        }
+    }
+    return 0;
 }
 
 /* 
@@ -657,15 +737,52 @@ int try_to_open_conf(char conf[][MAX_LEN])
 
 int main(int argc, char const *argv[])
 {
-    if (argc != 2)
+    // The configuration file may be followed by --watch, --workers N, --coordinator ADDR or --worker ADDR.
+    int watch = 0;
+    int workers = 0;
+    const char *coordinator = NULL;
+    const char *worker = NULL;
+    if (argc == 3 && strcmp(argv[2], "--watch") == 0)
+        watch = 1;
+    else if (argc == 4 && strcmp(argv[2], "--workers") == 0 && atoi(argv[3]) > 0)
+        workers = atoi(argv[3]);
+    else if (argc == 4 && strcmp(argv[2], "--coordinator") == 0)
+        coordinator = argv[3];
+    else if (argc == 4 && strcmp(argv[2], "--worker") == 0)
+        worker = argv[3];
+    else if (argc != 2)
     {
         return GEN_ERROR;
     }
 
-    char conf[3][MAX_LEN];
-    read_conf(argv[1], conf);
-    if (try_to_open_conf(conf))
+    char conf[CONF_LINES][MAX_LEN];
+    int lines = read_conf(argv[1], conf);
+    if (lines < 3 || try_to_open_conf(conf))
         return GEN_ERROR;
 
-    handle_students(conf);
+    Compiler cc;
+    compiler_defaults(&cc);
+    if (read_options(conf, lines, &cc))
+        return GEN_ERROR;
+
+    // Workers set up their own compiler, precompiled headers of a single process live for the whole run.
+    if (worker != NULL)
+        return work_for(worker, conf, &cc);
+    if (workers > 0)
+    {
+        char addr[MAX_LEN];
+        snprintf(addr, sizeof(addr), "unix:/tmp/grader_%d.sock", (int)getpid());
+        return coordinate_students(addr, workers, conf, &cc);
+    }
+    if (coordinator != NULL)
+        return coordinate_students(coordinator, 0, conf, &cc);
+
+    compiler_init(&cc);
+    int result = 0;
+    if (watch)
+        result = watch_students(conf, &cc, open_errors());
+    else
+        result = grade_all(conf, &cc);
+    compiler_destroy(&cc);
+    return result;
 }
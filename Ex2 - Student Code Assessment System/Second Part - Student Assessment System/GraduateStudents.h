@@ -0,0 +1,81 @@
+/*
+ * File: GraduateStudents.h
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  Return codes, limits and functions shared by GraduateStudents.c and its helper modules.
+ */
+
+#ifndef GRADUATE_STUDENTS_H
+#define GRADUATE_STUDENTS_H
+
+#define GEN_ERROR -1
+#define SAME 1
+#define DIFF 2
+#define SIMILAR 3
+#define COMPL_ERROR 4
+#define NO_C_FILE 5
+#define TIME_OUT 6
+#define MAX_LEN 151
+
+// Maximal number of lines in the configuration file (3 paths and optional settings).
+#define CONF_LINES 16
+
+// Maximal length of a line in results.csv.
+#define RESULT_LEN (MAX_LEN + 32)
+
+// Defined in Compiler.h.
+typedef struct Compiler Compiler;
+
+// Output of the student's program, "output.txt" unless a worker sets its own name.
+extern char output_file[MAX_LEN];
+
+/*
+ * find_c_file - Find the C file in the student's directory.
+ *
+ * Parameters:
+ *   const char* path - Path to the student's directory.
+ *   char* path_to_file - Buffer of MAX_LEN characters for the path to the C file.
+ *
+ * Returns:
+ *   1 - A C file was found.
+ *   0 - There is no C file in the directory.
+ *   GEN_ERROR - The directory cannot be opened.
+ */
+int find_c_file(const char *path, char *path_to_file);
+
+/*
+ * handle_student - Find a C file in the student's directory, compile it, execute it, and compare
+ * the output with the given correct output. The program's output goes to output_file, which is deleted at the end.
+ *
+ * Parameters:
+ *   const char* path - Path to the student's directory.
+ *   int errors - File descriptor of errors.txt.
+ *   char* input - Path to the input file.
+ *   char* output - Path to the output file.
+ *   Compiler* cc - Compiler settings.
+ *
+ * Returns:
+ *   GEN_ERROR, SAME, DIFF, SIMILAR, COMPL_ERROR, NO_C_FILE or TIME_OUT.
+ */
+int handle_student(const char *path, int errors, char *input, char *output, Compiler *cc);
+
+/*
+ * result_line - Build the line of results.csv with the student's name, grade, and explanation for the grade.
+ *
+ * Parameters:
+ *   int code - Code returned by handle_student.
+ *   const char* name - Student's name.
+ *   char* line - Buffer of RESULT_LEN characters for the line.
+ */
+void result_line(int code, const char *name, char *line);
+
+/*
+ * delete_file - Delete the specified file. Exits if unlink fails.
+ *
+ * Parameters:
+ *   char* filename - Path to the file to delete.
+ */
+void delete_file(char *filename);
+
+#endif // GRADUATE_STUDENTS_H
@@ -0,0 +1,167 @@
+/*
+ * File: Journal.c
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  Write-ahead journal of verdicts with batched fsync.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "Journal.h"
+
+
+void journal_key(char conf[][MAX_LEN], char *key)
+{
+    struct stat in, out;
+    memset(&in, 0, sizeof(in));
+    memset(&out, 0, sizeof(out));
+    stat(conf[1], &in);
+    stat(conf[2], &out);
+    snprintf(key, JOURNAL_KEY_LEN, "%s|%s|%ld|%ld.%09ld|%s|%ld|%ld.%09ld", conf[0],
+             conf[1], (long)in.st_size, (long)in.st_mtim.tv_sec, in.st_mtim.tv_nsec,
+             conf[2], (long)out.st_size, (long)out.st_mtim.tv_sec, out.st_mtim.tv_nsec);
+}
+
+
+/*
+ * write_all - Write the whole buffer, exits on failure.
+ */
+static void write_all(int fd, const char *buf, int len)
+{
+    while (len > 0)
+    {
+        ssize_t x = write(fd, buf, len);
+        if (x < 0)
+        {
+            perror("Error in: write");
+            exit(GEN_ERROR);
+        }
+        buf += x;
+        len -= x;
+    }
+}
+
+
+/*
+ * load_journal - Read the verdicts of a journal that belongs to the given key.
+ *
+ * Returns:
+ *   Offset after the last complete record, 0 if the journal is empty or belongs to another key.
+ */
+static off_t load_journal(int fd, const char *key, Results *done)
+{
+    FILE *file = fdopen(dup(fd), "r");
+    if (file == NULL)
+        return 0;
+
+    char line[JOURNAL_KEY_LEN + 4];
+    off_t good = 0;
+
+    // The first line has to be the key of the current configuration.
+    if (fgets(line, sizeof(line), file) != NULL && line[0] == '#' && line[1] == ' '
+        && strncmp(line + 2, key, strlen(key)) == 0 && strcmp(line + 2 + strlen(key), "\n") == 0)
+    {
+        good = strlen(line);
+        while (fgets(line, sizeof(line), file) != NULL)
+        {
+            int n = strlen(line);
+            int code;
+            char *name;
+
+            // A line without a newline was torn by a crash.
+            if (n == 0 || line[n - 1] != '\n')
+                break;
+            line[n - 1] = '\0';
+            code = strtol(line, &name, 10);
+            if (name == line || *name != ' ' || name[1] == '\0')
+                break;
+            results_set(done, name + 1, code);
+            good += n;
+        }
+    }
+    fclose(file);
+    return good;
+}
+
+
+int journal_open(Journal *j, const char *path, const char *key, Results *done)
+{
+    j->used = 0;
+    j->pending = 0;
+    clock_gettime(CLOCK_MONOTONIC, &j->last_sync);
+
+    j->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (j->fd < 0)
+    {
+        perror("Error in: open");
+        return GEN_ERROR;
+    }
+
+    // Keep the complete records of a matching journal, drop everything else.
+    off_t good = load_journal(j->fd, key, done);
+    if (ftruncate(j->fd, good) != 0 || lseek(j->fd, good, SEEK_SET) < 0)
+    {
+        perror("Error in: ftruncate");
+        close(j->fd);
+        return GEN_ERROR;
+    }
+    if (good == 0)
+    {
+        results_destroy(done);
+        results_init(done);
+        char header[JOURNAL_KEY_LEN + 4];
+        int len = snprintf(header, sizeof(header), "# %s\n", key);
+        write_all(j->fd, header, len);
+        fsync(j->fd);
+        return 0;
+    }
+
+    int count = 0;
+    for (int i = 0; i < done->n; i++)
+        count += done->items[i].active;
+    return count;
+}
+
+
+void journal_sync(Journal *j)
+{
+    if (j->used > 0)
+    {
+        write_all(j->fd, j->buf, j->used);
+        if (fdatasync(j->fd) != 0)
+            perror("Error in: fdatasync");
+    }
+    j->used = 0;
+    j->pending = 0;
+    clock_gettime(CLOCK_MONOTONIC, &j->last_sync);
+}
+
+
+void journal_append(Journal *j, const char *name, int code)
+{
+    if (j->used + MAX_LEN + 16 > JOURNAL_BUF)
+        journal_sync(j);
+    j->used += snprintf(j->buf + j->used, JOURNAL_BUF - j->used, "%d %s\n", code, name);
+    j->pending++;
+
+    // Sync after a full batch or when the batch got old.
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long ms = (now.tv_sec - j->last_sync.tv_sec) * 1000 + (now.tv_nsec - j->last_sync.tv_nsec) / 1000000;
+    if (j->pending >= JOURNAL_BATCH || ms >= JOURNAL_SYNC_MS)
+        journal_sync(j);
+}
+
+
+void journal_close(Journal *j, const char *path, int remove)
+{
+    journal_sync(j);
+    close(j->fd);
+    if (remove && unlink(path) != 0)
+        perror("Error in: unlink");
+}
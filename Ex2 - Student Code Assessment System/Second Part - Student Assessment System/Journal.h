@@ -0,0 +1,98 @@
+/*
+ * File: Journal.h
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  Write-ahead journal of verdicts that lets a long grading run resume after a crash.
+ *  Every graded student is appended to "results.journal" and the journal is written and
+ *  fsynced in batches: after JOURNAL_BATCH verdicts or JOURNAL_SYNC_MS milliseconds,
+ *  whichever comes first. A crash loses at most the unsynced batch.
+ *
+ *  File format:
+ *    # <key>            - first line, identifies the configuration the verdicts belong to
+ *    <code> <name>      - one line per graded student
+ *  A last line without a newline was torn by the crash and is dropped.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <time.h>
+#include "GraduateStudents.h"
+#include "Results.h"
+
+#define JOURNAL_BATCH 32
+#define JOURNAL_SYNC_MS 1000
+#define JOURNAL_KEY_LEN (4 * MAX_LEN)
+#define JOURNAL_BUF (JOURNAL_BATCH * (MAX_LEN + 16))
+
+/*
+ * Journal - Open journal and the batch that was not written yet.
+ *  - fd: File descriptor of the journal.
+ *  - buf, used: Records of the current batch.
+ *  - pending: Number of records in the current batch.
+ *  - last_sync: Time of the last fsync.
+ */
+typedef struct
+{
+    int fd;
+    char buf[JOURNAL_BUF];
+    int used;
+    int pending;
+    struct timespec last_sync;
+} Journal;
+
+/*
+ * journal_key - Build the key of a configuration: paths of the students' directory, input and
+ * correct output, and the size and modification time of the last two.
+ *
+ * Parameters:
+ *   char conf[][MAX_LEN] - Configuration data.
+ *   char* key - Buffer of JOURNAL_KEY_LEN characters.
+ */
+void journal_key(char conf[][MAX_LEN], char *key);
+
+/*
+ * journal_open - Open the journal and load the verdicts it holds.
+ * If the journal belongs to another configuration it is started from scratch.
+ *
+ * Parameters:
+ *   Journal* j - Journal to open.
+ *   const char* path - Path to the journal file.
+ *   const char* key - Key of the current configuration.
+ *   Results* done - Table to fill with the verdicts found in the journal.
+ *
+ * Returns:
+ *   Number of loaded verdicts, GEN_ERROR if the journal cannot be opened.
+ */
+int journal_open(Journal *j, const char *path, const char *key, Results *done);
+
+/*
+ * journal_append - Add a verdict to the current batch, write and fsync the batch when it is due.
+ *
+ * Parameters:
+ *   Journal* j - Open journal.
+ *   const char* name - Name of the student.
+ *   int code - Code returned by handle_student.
+ */
+void journal_append(Journal *j, const char *name, int code);
+
+/*
+ * journal_sync - Write and fsync the current batch.
+ *
+ * Parameters:
+ *   Journal* j - Open journal.
+ */
+void journal_sync(Journal *j);
+
+/*
+ * journal_close - Sync and close the journal.
+ *
+ * Parameters:
+ *   Journal* j - Open journal.
+ *   const char* path - Path to the journal file.
+ *   int remove - 1 to delete the journal (the run finished and results.csv is written).
+ */
+void journal_close(Journal *j, const char *path, int remove);
+
+#endif // JOURNAL_H
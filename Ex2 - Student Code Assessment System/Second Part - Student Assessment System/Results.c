@@ -0,0 +1,191 @@
+/*
+ * File: Results.c
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  In-memory table of verdicts with atomic writing of results.csv.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Results.h"
+
+
+/*
+ * hash_name - FNV-1a hash of a student's name.
+ */
+static unsigned int hash_name(const char *name)
+{
+    unsigned int h = 2166136261u;
+    for (; *name != '\0'; name++)
+    {
+        h ^= (unsigned char)*name;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+
+/*
+ * find_slot - Find the slot of the hash table that holds the given name or the empty slot where it should be.
+ */
+static int find_slot(Results *r, const char *name)
+{
+    int slot = hash_name(name) & r->mask;
+    while (r->index[slot] != -1 && strcmp(r->items[r->index[slot]].name, name) != 0)
+        slot = (slot + 1) & r->mask;
+    return slot;
+}
+
+
+/*
+ * grow - Double the items array and the hash table.
+ */
+static void grow(Results *r)
+{
+    r->cap *= 2;
+    r->items = (Result *)realloc(r->items, r->cap * sizeof(Result));
+    free(r->index);
+    r->mask = r->cap * 2 - 1;
+    r->index = (int *)malloc((r->mask + 1) * sizeof(int));
+    if (r->items == NULL || r->index == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(GEN_ERROR);
+    }
+
+    // Rebuild the hash table.
+    memset(r->index, -1, (r->mask + 1) * sizeof(int));
+    for (int i = 0; i < r->n; i++)
+        r->index[find_slot(r, r->items[i].name)] = i;
+}
+
+
+void results_init(Results *r)
+{
+    r->n = 0;
+    r->cap = 64;
+    r->mask = r->cap * 2 - 1;
+    r->items = (Result *)malloc(r->cap * sizeof(Result));
+    r->index = (int *)malloc((r->mask + 1) * sizeof(int));
+    if (r->items == NULL || r->index == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(GEN_ERROR);
+    }
+    memset(r->index, -1, (r->mask + 1) * sizeof(int));
+}
+
+
+Result *results_find(Results *r, const char *name)
+{
+    int slot = find_slot(r, name);
+    if (r->index[slot] == -1 || !r->items[r->index[slot]].active)
+        return NULL;
+    return &r->items[r->index[slot]];
+}
+
+
+void results_set(Results *r, const char *name, int code)
+{
+    int slot = find_slot(r, name);
+
+    // Removed students keep their item, so it is simply reused.
+    if (r->index[slot] == -1)
+    {
+        if (r->n == r->cap)
+        {
+            grow(r);
+            slot = find_slot(r, name);
+        }
+        strncpy(r->items[r->n].name, name, MAX_LEN - 1);
+        r->items[r->n].name[MAX_LEN - 1] = '\0';
+        r->index[slot] = r->n++;
+    }
+    r->items[r->index[slot]].code = code;
+    r->items[r->index[slot]].active = 1;
+}
+
+
+void results_remove(Results *r, const char *name)
+{
+    Result *res = results_find(r, name);
+    if (res != NULL)
+        res->active = 0;
+}
+
+
+/*
+ * compare_results - Order verdicts by name for qsort.
+ */
+static int compare_results(const void *a, const void *b)
+{
+    return strcmp((*(Result **)a)->name, (*(Result **)b)->name);
+}
+
+
+int results_write(Results *r, const char *path)
+{
+    // Sort the active verdicts by name.
+    Result **sorted = (Result **)malloc((r->n + 1) * sizeof(Result *));
+    if (sorted == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(GEN_ERROR);
+    }
+    int n = 0;
+    for (int i = 0; i < r->n; i++)
+    {
+        if (r->items[i].active)
+            sorted[n++] = &r->items[i];
+    }
+    qsort(sorted, n, sizeof(Result *), compare_results);
+
+    // Write them to a temporary file next to the target.
+    char tmp[MAX_LEN + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *file = fopen(tmp, "w");
+    if (file == NULL)
+    {
+        perror("Error in: fopen");
+        free(sorted);
+        return GEN_ERROR;
+    }
+    char line[RESULT_LEN];
+    for (int i = 0; i < n; i++)
+    {
+        result_line(sorted[i]->code, sorted[i]->name, line);
+        fputs(line, file);
+    }
+    free(sorted);
+
+    // Make sure the data is on disk before it replaces the old file.
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0)
+    {
+        perror("Error in: write");
+        fclose(file);
+        unlink(tmp);
+        return GEN_ERROR;
+    }
+    fclose(file);
+    if (rename(tmp, path) != 0)
+    {
+        perror("Error in: rename");
+        unlink(tmp);
+        return GEN_ERROR;
+    }
+    return 0;
+}
+
+
+void results_destroy(Results *r)
+{
+    free(r->items);
+    free(r->index);
+    r->items = NULL;
+    r->index = NULL;
+    r->n = r->cap = 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * File: Results.h
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  In-memory table of verdicts, one per student, that is written to results.csv as a whole.
+ *  The file is written to a temporary file and renamed over results.csv, so readers
+ *  always see either the old or the new complete table.
+ */
+
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include "GraduateStudents.h"
+
+/*
+ * Result - Verdict of one student.
+ *  - name: Name of the student's directory.
+ *  - code: Code returned by handle_student.
+ *  - active: 0 if the student was removed from the table.
+ */
+typedef struct
+{
+    char name[MAX_LEN];
+    int code;
+    int active;
+} Result;
+
+/*
+ * Results - Table of verdicts.
+ *  - items: Verdicts in the order they were added.
+ *  - n: Number of used items (including removed ones).
+ *  - cap: Number of allocated items.
+ *  - index: Hash table of item indexes by name, -1 marks an empty slot.
+ *  - mask: Size of the hash table minus one (the size is a power of two).
+ */
+typedef struct
+{
+    Result *items;
+    int n;
+    int cap;
+    int *index;
+    int mask;
+} Results;
+
+/*
+ * results_init - Initialize an empty table.
+ *
+ * Parameters:
+ *   Results* r - Table to initialize.
+ */
+void results_init(Results *r);
+
+/*
+ * results_set - Add or replace the verdict of a student.
+ *
+ * Parameters:
+ *   Results* r - Table of verdicts.
+ *   const char* name - Name of the student.
+ *   int code - Code returned by handle_student.
+ */
+void results_set(Results *r, const char *name, int code);
+
+/*
+ * results_find - Find the verdict of a student.
+ *
+ * Parameters:
+ *   Results* r - Table of verdicts.
+ *   const char* name - Name of the student.
+ *
+ * Returns:
+ *   Pointer to the verdict, NULL if the student is not in the table.
+ */
+Result *results_find(Results *r, const char *name);
+
+/*
+ * results_remove - Remove the verdict of a student, if there is one.
+ *
+ * Parameters:
+ *   Results* r - Table of verdicts.
+ *   const char* name - Name of the student.
+ */
+void results_remove(Results *r, const char *name);
+
+/*
+ * results_write - Write all verdicts sorted by name to the given file atomically.
+ *
+ * Parameters:
+ *   Results* r - Table of verdicts.
+ *   const char* path - Path to the file, usually "results.csv".
+ *
+ * Returns:
+ *   0 - Success.
+ *   GEN_ERROR - The file could not be written, the old file is left as is.
+ */
+int results_write(Results *r, const char *path);
+
+/*
+ * results_destroy - Release the memory of the table.
+ *
+ * Parameters:
+ *   Results* r - Table of verdicts.
+ */
+void results_destroy(Results *r);
+
+#endif // RESULTS_H
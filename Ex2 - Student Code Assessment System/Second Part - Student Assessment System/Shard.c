@@ -0,0 +1,831 @@
+/*
+ * File: Shard.c
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  Coordinator and worker of the sharded grading mode.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "Shard.h"
+#include "Compiler.h"
+#include "Results.h"
+#include "Journal.h"
+
+#define SHARD_QUEUED 0
+#define SHARD_ASSIGNED 1
+#define SHARD_DONE 2
+
+/*
+ * Shard - Range [start, end) of the students to grade and its state.
+ *  - lease: While assigned, time until which its worker may stay silent. Every verdict renews it.
+ */
+typedef struct
+{
+    int start;
+    int end;
+    int state;
+    long lease;
+} Shard;
+
+/*
+ * Worker_Conn - Connection of a worker and its metrics.
+ *  - fd: Socket, -1 after the worker disconnected.
+ *  - name: "host pid" sent by the worker.
+ *  - pid: Process ID of a local worker, 0 for a remote one.
+ *  - shard: Shard the worker is grading, -1 if none.
+ *  - waiting: 1 if the worker asked for work and there was none to give.
+ *  - graded: Number of verdicts received from the worker.
+ *  - wall_ms, cpu_ms: Totals reported by the worker at the end of its shards.
+ *  - in, in_len: Bytes received and not handled yet, at most one frame and the start of the next one.
+ */
+typedef struct
+{
+    int fd;
+    char name[64];
+    pid_t pid;
+    int shard;
+    int waiting;
+    int graded;
+    long wall_ms;
+    long cpu_ms;
+    char *in;
+    int in_len;
+} Worker_Conn;
+
+/*
+ * Coordinator - State of the coordinator.
+ *  - pids, n_pids: Local workers forked by the coordinator.
+ */
+typedef struct
+{
+    char (*names)[MAX_LEN];
+    int n_names;
+    Shard *shards;
+    int n_shards;
+    int left;
+    Worker_Conn *conns;
+    int n_conns;
+    pid_t *pids;
+    int n_pids;
+    Results results;
+    Journal journal;
+} Coordinator;
+
+
+/*
+ * now_ms - Monotonic time in milliseconds.
+ */
+static long now_ms()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+
+/*
+ * open_socket - Listen on or connect to the given address.
+ *
+ * Parameters:
+ *   const char* addr - "unix:/path" or "host:port".
+ *   int listening - 1 to bind and listen, 0 to connect.
+ *
+ * Returns:
+ *   Socket file descriptor, GEN_ERROR on failure.
+ */
+static int open_socket(const char *addr, int listening)
+{
+    int fd;
+
+    // Unix socket.
+    if (strncmp(addr, "unix:", 5) == 0)
+    {
+        struct sockaddr_un sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sun_family = AF_UNIX;
+        if (strlen(addr + 5) >= sizeof(sa.sun_path))
+            return GEN_ERROR;
+        strcpy(sa.sun_path, addr + 5);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            perror("Error in: socket");
+            return GEN_ERROR;
+        }
+        if (listening)
+        {
+            unlink(sa.sun_path);
+            if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0 || listen(fd, 64) != 0)
+            {
+                perror("Error in: bind");
+                close(fd);
+                return GEN_ERROR;
+            }
+        }
+        else if (connect(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0)
+        {
+            perror("Error in: connect");
+            close(fd);
+            return GEN_ERROR;
+        }
+        return fd;
+    }
+
+    // TCP socket: split "host:port" at the last colon.
+    char host[MAX_LEN];
+    const char *colon = strrchr(addr, ':');
+    if (colon == NULL || colon - addr >= MAX_LEN)
+        return GEN_ERROR;
+    memcpy(host, addr, colon - addr);
+    host[colon - addr] = '\0';
+
+    struct addrinfo hints, *res, *ai;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listening ? AI_PASSIVE : 0;
+    if (getaddrinfo(host[0] ? host : NULL, colon + 1, &hints, &res) != 0)
+    {
+        printf("Error! Unknown address %s\n", addr);
+        return GEN_ERROR;
+    }
+
+    fd = GEN_ERROR;
+    for (ai = res; ai != NULL; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        if (listening)
+        {
+            int one = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 64) == 0)
+                break;
+        }
+        else if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        close(fd);
+        fd = GEN_ERROR;
+    }
+    freeaddrinfo(res);
+    if (fd < 0)
+        perror(listening ? "Error in: bind" : "Error in: connect");
+    return fd;
+}
+
+
+/*
+ * send_frame - Send one frame.
+ *
+ * Returns:
+ *   0 - Success.
+ *   GEN_ERROR - The peer is gone.
+ */
+static int send_frame(int fd, int type, const char *payload, int len)
+{
+    char buf[MAX_FRAME + 5];
+    if (len > MAX_FRAME)
+        return GEN_ERROR;
+    buf[0] = (len >> 24) & 0xff;
+    buf[1] = (len >> 16) & 0xff;
+    buf[2] = (len >> 8) & 0xff;
+    buf[3] = len & 0xff;
+    buf[4] = type;
+    memcpy(buf + 5, payload, len);
+
+    char *p = buf;
+    int left = len + 5;
+    while (left > 0)
+    {
+        ssize_t x = send(fd, p, left, MSG_NOSIGNAL);
+        if (x < 0 && errno == EINTR)
+            continue;
+        if (x <= 0)
+            return GEN_ERROR;
+        p += x;
+        left -= x;
+    }
+    return 0;
+}
+
+
+/*
+ * read_full - Read exactly len bytes. Workers only, the coordinator never blocks on a read.
+ */
+static int read_full(int fd, char *buf, int len)
+{
+    while (len > 0)
+    {
+        ssize_t x = read(fd, buf, len);
+        if (x < 0 && errno == EINTR)
+            continue;
+        if (x <= 0)
+            return GEN_ERROR;
+        buf += x;
+        len -= x;
+    }
+    return 0;
+}
+
+
+/*
+ * recv_frame - Receive one frame. The payload is null-terminated.
+ *
+ * Parameters:
+ *   int fd - Socket.
+ *   int* type - Type of the frame.
+ *   char* payload - Buffer of MAX_FRAME + 1 characters.
+ *
+ * Returns:
+ *   Length of the payload, GEN_ERROR if the peer is gone or the frame is too long.
+ */
+static int recv_frame(int fd, int *type, char *payload)
+{
+    unsigned char head[5];
+    if (read_full(fd, (char *)head, 5) != 0)
+        return GEN_ERROR;
+    int len = (head[0] << 24) | (head[1] << 16) | (head[2] << 8) | head[3];
+    if (len < 0 || len > MAX_FRAME || read_full(fd, payload, len) != 0)
+        return GEN_ERROR;
+    payload[len] = '\0';
+    *type = head[4];
+    return len;
+}
+
+
+int work_for(const char *addr, char conf[][MAX_LEN], Compiler *cc)
+{
+    int fd = open_socket(addr, 0);
+    if (fd < 0)
+        return GEN_ERROR;
+
+    // Workers may share a directory, so each one has its own output file.
+    snprintf(output_file, MAX_LEN, "output.%d.txt", (int)getpid());
+    int errors = open("errors.txt", O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (errors < 0)
+    {
+        perror("Error in: open");
+        close(fd);
+        return GEN_ERROR;
+    }
+    compiler_init(cc);
+
+    char *buf = (char *)malloc(MAX_FRAME + 1);
+    if (buf == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(GEN_ERROR);
+    }
+
+    // Introduce ourselves.
+    char host[32];
+    char msg[MAX_LEN + 32];
+    if (gethostname(host, sizeof(host)) != 0)
+        strcpy(host, "?");
+    host[sizeof(host) - 1] = '\0';
+    int len = snprintf(msg, sizeof(msg), "%s %d", host, (int)getpid());
+    int result = send_frame(fd, FRAME_HELLO, msg, len);
+
+    int type;
+    while (result == 0)
+    {
+        // Ask for a shard.
+        if (send_frame(fd, FRAME_GET, "", 0) != 0 || recv_frame(fd, &type, buf) < 0)
+        {
+            result = GEN_ERROR;
+            break;
+        }
+        if (type == FRAME_BYE)
+            break;
+        if (type != FRAME_SHARD)
+            continue;
+
+        long start = now_ms();
+        struct rusage self0, children0, self1, children1;
+        getrusage(RUSAGE_SELF, &self0);
+        getrusage(RUSAGE_CHILDREN, &children0);
+
+        // Grade every student of the shard and send the verdict right away.
+        int graded = 0;
+        char *save;
+        for (char *name = strtok_r(buf, "\n", &save); name != NULL; name = strtok_r(NULL, "\n", &save))
+        {
+            char path[MAX_LEN];
+            if (strlen(conf[0]) + strlen(name) + 2 > MAX_LEN)
+                continue;
+            sprintf(path, "%s/%s", conf[0], name);
+            int code = handle_student(path, errors, conf[1], conf[2], cc);
+            len = snprintf(msg, sizeof(msg), "%d %s", code, name);
+            if (send_frame(fd, FRAME_VERDICT, msg, len) != 0)
+            {
+                result = GEN_ERROR;
+                break;
+            }
+            graded++;
+        }
+
+        // Report the metrics of the shard.
+        getrusage(RUSAGE_SELF, &self1);
+        getrusage(RUSAGE_CHILDREN, &children1);
+        long cpu_us = (self1.ru_utime.tv_sec - self0.ru_utime.tv_sec + self1.ru_stime.tv_sec - self0.ru_stime.tv_sec
+                       + children1.ru_utime.tv_sec - children0.ru_utime.tv_sec
+                       + children1.ru_stime.tv_sec - children0.ru_stime.tv_sec) * 1000000L
+                      + self1.ru_utime.tv_usec - self0.ru_utime.tv_usec + self1.ru_stime.tv_usec - self0.ru_stime.tv_usec
+                      + children1.ru_utime.tv_usec - children0.ru_utime.tv_usec
+                      + children1.ru_stime.tv_usec - children0.ru_stime.tv_usec;
+        len = snprintf(msg, sizeof(msg), "%d %ld %ld", graded, now_ms() - start, cpu_us / 1000);
+        if (result == 0 && send_frame(fd, FRAME_METRICS, msg, len) != 0)
+            result = GEN_ERROR;
+    }
+
+    free(buf);
+    compiler_destroy(cc);
+    close(errors);
+    close(fd);
+    return result;
+}
+
+
+/*
+ * assign_shard - Give the worker the next queued shard, or tell it that the work is over.
+ * Only students without a verdict are sent, a re-queued shard may be partly graded.
+ */
+static void assign_shard(Coordinator *c, Worker_Conn *w)
+{
+    w->waiting = 0;
+    for (int i = 0; i < c->n_shards; i++)
+    {
+        Shard *s = &c->shards[i];
+        if (s->state != SHARD_QUEUED)
+            continue;
+
+        char payload[SHARD_SIZE * (MAX_LEN + 1)];
+        int len = 0;
+        for (int k = s->start; k < s->end; k++)
+        {
+            if (results_find(&c->results, c->names[k]) == NULL)
+                len += sprintf(payload + len, "%s\n", c->names[k]);
+        }
+        if (len == 0)
+        {
+            s->state = SHARD_DONE;
+            continue;
+        }
+        s->state = SHARD_ASSIGNED;
+        s->lease = now_ms() + SHARD_LEASE_MS;
+        w->shard = i;
+        send_frame(w->fd, FRAME_SHARD, payload, len);
+        return;
+    }
+
+    // Nothing queued: finish the worker, or park it while other shards may still come back.
+    if (c->left == 0)
+        send_frame(w->fd, FRAME_BYE, "", 0);
+    else
+        w->waiting = 1;
+}
+
+
+/*
+ * drop_worker - Close the connection of a worker and queue its shard again.
+ */
+static void drop_worker(Coordinator *c, Worker_Conn *w)
+{
+    close(w->fd);
+    w->fd = -1;
+    w->waiting = 0;
+    free(w->in);
+    w->in = NULL;
+    w->in_len = 0;
+    if (w->shard >= 0)
+    {
+        c->shards[w->shard].state = SHARD_QUEUED;
+        w->shard = -1;
+
+        // A parked worker can take it.
+        for (int i = 0; i < c->n_conns; i++)
+        {
+            if (c->conns[i].fd >= 0 && c->conns[i].waiting)
+            {
+                assign_shard(c, &c->conns[i]);
+                break;
+            }
+        }
+    }
+}
+
+
+/*
+ * shard_has - 1 if the student is one of the shard's, 0 otherwise.
+ */
+static int shard_has(Coordinator *c, Shard *s, const char *name)
+{
+    for (int k = s->start; k < s->end; k++)
+    {
+        if (strcmp(c->names[k], name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+
+/*
+ * handle_frame - Handle one frame from a worker. The payload is null-terminated.
+ */
+static void handle_frame(Coordinator *c, Worker_Conn *w, int type, char *buf)
+{
+    switch (type)
+    {
+    case FRAME_HELLO:
+    {
+        strncpy(w->name, buf, sizeof(w->name) - 1);
+
+        // A local worker can be killed if it stops answering.
+        char *pid = strrchr(w->name, ' ');
+        int id = pid != NULL ? atoi(pid + 1) : 0;
+        for (int i = 0; i < c->n_pids; i++)
+        {
+            if (c->pids[i] == id)
+                w->pid = id;
+        }
+        break;
+    }
+    case FRAME_GET:
+        assign_shard(c, w);
+        break;
+    case FRAME_VERDICT:
+    {
+        char *name;
+        int code = strtol(buf, &name, 10);
+        if (name == buf || *name != ' ')
+            break;
+        name++;
+
+        // Only a first verdict of a student of the worker's shard counts, a stray or garbled frame is dropped.
+        if (code < SAME || code > TIME_OUT || w->shard < 0 || !shard_has(c, &c->shards[w->shard], name)
+            || results_find(&c->results, name) != NULL)
+        {
+            printf("Dropped a verdict of worker %s: \"%s\"\n", w->name, buf);
+            break;
+        }
+        c->left--;
+        results_set(&c->results, name, code);
+        journal_append(&c->journal, name, code);
+        w->graded++;
+        c->shards[w->shard].lease = now_ms() + SHARD_LEASE_MS;
+        break;
+    }
+    case FRAME_METRICS:
+    {
+        int graded;
+        long wall, cpu;
+        if (sscanf(buf, "%d %ld %ld", &graded, &wall, &cpu) == 3)
+        {
+            w->wall_ms += wall;
+            w->cpu_ms += cpu;
+        }
+        if (w->shard >= 0)
+            c->shards[w->shard].state = SHARD_DONE;
+        w->shard = -1;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+
+/*
+ * read_frames - Read what a worker sent without blocking and handle every complete frame.
+ * A partial frame stays in the connection's buffer until the rest arrives.
+ */
+static void read_frames(Coordinator *c, Worker_Conn *w, char *buf)
+{
+    while (w->fd >= 0)
+    {
+        ssize_t x = recv(w->fd, w->in + w->in_len, MAX_FRAME + 5 - w->in_len, MSG_DONTWAIT);
+        if (x < 0 && errno == EINTR)
+            continue;
+        if (x < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (x <= 0)
+        {
+            drop_worker(c, w);
+            return;
+        }
+        w->in_len += x;
+
+        // Handle the complete frames and keep the rest.
+        int used = 0;
+        while (w->fd >= 0 && w->in_len - used >= 5)
+        {
+            unsigned char *head = (unsigned char *)w->in + used;
+            int len = (head[0] << 24) | (head[1] << 16) | (head[2] << 8) | head[3];
+            if (len < 0 || len > MAX_FRAME)
+            {
+                drop_worker(c, w);
+                return;
+            }
+            if (w->in_len - used < len + 5)
+                break;
+            memcpy(buf, w->in + used + 5, len);
+            buf[len] = '\0';
+            used += len + 5;
+            handle_frame(c, w, head[4], buf);
+        }
+        if (w->fd < 0)
+            return;
+        memmove(w->in, w->in + used, w->in_len - used);
+        w->in_len -= used;
+    }
+}
+
+
+/*
+ * expire_leases - Drop the workers that sent no verdict within the lease of their shard, so the shard is
+ * handed out again. A local worker is killed, it would otherwise keep the coordinator waiting at the end.
+ */
+static void expire_leases(Coordinator *c)
+{
+    long now = now_ms();
+    for (int i = 0; i < c->n_conns; i++)
+    {
+        Worker_Conn *w = &c->conns[i];
+        if (w->fd < 0 || w->shard < 0 || now < c->shards[w->shard].lease)
+            continue;
+        printf("Worker %s did not answer for %d ms, its shard is handed out again\n", w->name, SHARD_LEASE_MS);
+        if (w->pid > 0)
+            kill(w->pid, SIGKILL);
+        drop_worker(c, w);
+    }
+}
+
+
+/*
+ * busy_workers - Number of workers that did not report the metrics of their shard yet.
+ */
+static int busy_workers(Coordinator *c)
+{
+    int busy = 0;
+    for (int i = 0; i < c->n_conns; i++)
+        busy += c->conns[i].fd >= 0 && c->conns[i].shard >= 0;
+    return busy;
+}
+
+
+/*
+ * list_students - Read the students' directory. Students with a verdict in the journal keep it,
+ * the others are added to the list of names to grade.
+ */
+static int list_students(Coordinator *c, const char *students_dir, Results *done)
+{
+    DIR *pDir = opendir(students_dir);
+    struct dirent *pDirent;
+    int cap = 64;
+    if (pDir == NULL)
+    {
+        perror("Error in: opendir");
+        return GEN_ERROR;
+    }
+    c->names = malloc(cap * MAX_LEN);
+    c->n_names = 0;
+    while (c->names != NULL && (pDirent = readdir(pDir)) != NULL)
+    {
+        if (pDirent->d_type != DT_DIR || strcmp(pDirent->d_name, ".") == 0 || strcmp(pDirent->d_name, "..") == 0)
+            continue;
+        Result *old = results_find(done, pDirent->d_name);
+        if (old != NULL)
+        {
+            results_set(&c->results, pDirent->d_name, old->code);
+            continue;
+        }
+        if (c->n_names == cap)
+        {
+            cap *= 2;
+            c->names = realloc(c->names, cap * MAX_LEN);
+            if (c->names == NULL)
+                break;
+        }
+        strncpy(c->names[c->n_names], pDirent->d_name, MAX_LEN - 1);
+        c->names[c->n_names][MAX_LEN - 1] = '\0';
+        c->n_names++;
+    }
+    closedir(pDir);
+    if (c->names == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(GEN_ERROR);
+    }
+    return 0;
+}
+
+
+int coordinate_students(const char *addr, int local_workers, char conf[][MAX_LEN], Compiler *cc)
+{
+    Coordinator c;
+    memset(&c, 0, sizeof(c));
+    long start = now_ms();
+
+    int lfd = open_socket(addr, 1);
+    if (lfd < 0)
+        return GEN_ERROR;
+
+    // Fork local workers before anything else is opened.
+    fflush(stdout);
+    int children = 0;
+    c.pids = (pid_t *)malloc((local_workers + 1) * sizeof(pid_t));
+    if (c.pids == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(GEN_ERROR);
+    }
+    for (int i = 0; i < local_workers; i++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(lfd);
+            exit(work_for(addr, conf, cc) == 0 ? 0 : 1);
+        }
+        else if (pid < 0)
+            perror("Error in: fork");
+        else
+        {
+            c.pids[c.n_pids++] = pid;
+            children++;
+        }
+    }
+
+    // Resume from the journal and split the rest into shards.
+    Results done;
+    char key[JOURNAL_KEY_LEN];
+    results_init(&done);
+    results_init(&c.results);
+    journal_key(conf, key);
+    int resumed = journal_open(&c.journal, "results.journal", key, &done);
+    if (resumed == GEN_ERROR || list_students(&c, conf[0], &done) != 0)
+    {
+        close(lfd);
+        free(c.pids);
+        return GEN_ERROR;
+    }
+    results_destroy(&done);
+    if (resumed > 0)
+        printf("Resuming: %d students already graded\n", resumed);
+
+    c.left = c.n_names;
+    c.n_shards = (c.n_names + SHARD_SIZE - 1) / SHARD_SIZE;
+    c.shards = (Shard *)malloc((c.n_shards + 1) * sizeof(Shard));
+    c.conns = NULL;
+    if (c.shards == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(GEN_ERROR);
+    }
+    for (int i = 0; i < c.n_shards; i++)
+    {
+        c.shards[i].start = i * SHARD_SIZE;
+        c.shards[i].end = (i + 1) * SHARD_SIZE < c.n_names ? (i + 1) * SHARD_SIZE : c.n_names;
+        c.shards[i].state = SHARD_QUEUED;
+    }
+    if (!local_workers)
+        printf("Waiting for workers on %s\n", addr);
+    fflush(stdout);
+
+    char *buf = (char *)malloc(MAX_FRAME + 1);
+    struct pollfd *pfds = NULL;
+    int cap = 0;
+    int result = 0;
+    while (c.left > 0 || busy_workers(&c) > 0)
+    {
+        // Local mode fails if every worker is gone.
+        while (children > 0 && waitpid(-1, NULL, WNOHANG) > 0)
+            children--;
+        int connected = 0;
+        for (int i = 0; i < c.n_conns; i++)
+            connected += c.conns[i].fd >= 0;
+        if (local_workers && children == 0 && connected == 0)
+        {
+            printf("Error! All workers exited, %d students left\n", c.left);
+            result = GEN_ERROR;
+            break;
+        }
+
+        // Poll the listening socket and every connected worker.
+        if (cap < c.n_conns + 1)
+        {
+            cap = (c.n_conns + 1) * 2;
+            pfds = (struct pollfd *)realloc(pfds, cap * sizeof(struct pollfd));
+        }
+        if (pfds == NULL || buf == NULL)
+        {
+            printf("Error! Memory allocating\n");
+            exit(GEN_ERROR);
+        }
+        pfds[0].fd = lfd;
+        pfds[0].events = POLLIN;
+        for (int i = 0; i < c.n_conns; i++)
+        {
+            pfds[i + 1].fd = c.conns[i].fd;
+            pfds[i + 1].events = POLLIN;
+        }
+        int n_pfds = c.n_conns + 1;
+        if (poll(pfds, n_pfds, 1000) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("Error in: poll");
+            result = GEN_ERROR;
+            break;
+        }
+
+        for (int i = 1; i < n_pfds; i++)
+        {
+            if (pfds[i].fd >= 0 && (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                read_frames(&c, &c.conns[i - 1], buf);
+        }
+        expire_leases(&c);
+
+        // A new worker connected.
+        if (pfds[0].revents & POLLIN)
+        {
+            int fd = accept(lfd, NULL, NULL);
+            if (fd >= 0)
+            {
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+                c.conns = (Worker_Conn *)realloc(c.conns, (c.n_conns + 1) * sizeof(Worker_Conn));
+                if (c.conns == NULL)
+                {
+                    printf("Error! Memory allocating\n");
+                    exit(GEN_ERROR);
+                }
+                Worker_Conn *w = &c.conns[c.n_conns++];
+                memset(w, 0, sizeof(Worker_Conn));
+                w->fd = fd;
+                w->shard = -1;
+                w->in = (char *)malloc(MAX_FRAME + 5);
+                if (w->in == NULL)
+                {
+                    printf("Error! Memory allocating\n");
+                    exit(GEN_ERROR);
+                }
+            }
+        }
+    }
+
+    // Tell every worker that the work is over.
+    for (int i = 0; i < c.n_conns; i++)
+    {
+        if (c.conns[i].fd >= 0)
+        {
+            send_frame(c.conns[i].fd, FRAME_BYE, "", 0);
+            close(c.conns[i].fd);
+            free(c.conns[i].in);
+        }
+    }
+    close(lfd);
+    if (strncmp(addr, "unix:", 5) == 0)
+        unlink(addr + 5);
+    while (children > 0 && wait(NULL) > 0)
+        children--;
+
+    // Write results.csv and drop the journal, or keep it for the next run.
+    journal_sync(&c.journal);
+    if (result == 0)
+        result = results_write(&c.results, "results.csv");
+    journal_close(&c.journal, "results.journal", result == 0);
+
+    long wall = now_ms() - start;
+    for (int i = 0; i < c.n_conns; i++)
+    {
+        Worker_Conn *w = &c.conns[i];
+        printf("worker %s: %d students, %ld ms grading, %ld ms CPU\n", w->name, w->graded, w->wall_ms, w->cpu_ms);
+    }
+    printf("graded %d students in %ld ms (%.1f students/s)\n", c.n_names - c.left, wall,
+           wall > 0 ? (c.n_names - c.left) * 1000.0 / wall : 0.0);
+
+    free(buf);
+    free(pfds);
+    free(c.names);
+    free(c.shards);
+    free(c.conns);
+    free(c.pids);
+    results_destroy(&c.results);
+    return result;
+}
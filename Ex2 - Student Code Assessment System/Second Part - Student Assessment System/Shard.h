@@ -0,0 +1,67 @@
+/*
+ * File: Shard.h
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  Coordinator/worker mode: the coordinator splits the students into shards of SHARD_SIZE students
+ *  and hands them out to workers connected over a Unix or TCP socket. Workers grade the students of
+ *  a shard, stream every verdict back, and report their metrics at the end of the shard.
+ *  The coordinator keeps the journal and writes results.csv, like a single process run does.
+ *  A shard of a worker that disconnects, or sends no verdict for SHARD_LEASE_MS, is handed out again.
+ *  A verdict counts only for a student of the worker's current shard that has none yet, others are dropped.
+ *
+ *  Addresses: "unix:/path/to/socket" or "host:port" (":port" listens on all interfaces).
+ *  Workers on other hosts must see the students' directory, input and correct output at the same paths.
+ *
+ *  Protocol: every frame is a 4-byte big-endian payload length, a 1-byte type and the payload.
+ *    worker -> coordinator: FRAME_HELLO "host pid", FRAME_GET, FRAME_VERDICT "code name",
+ *                           FRAME_METRICS "students wall_ms cpu_ms"
+ *    coordinator -> worker: FRAME_SHARD "name\nname\n...", FRAME_BYE
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "GraduateStudents.h"
+
+#define SHARD_SIZE 16
+#define MAX_FRAME 65536
+#define SHARD_LEASE_MS 60000
+
+#define FRAME_HELLO 1
+#define FRAME_GET 2
+#define FRAME_SHARD 3
+#define FRAME_VERDICT 4
+#define FRAME_METRICS 5
+#define FRAME_BYE 6
+
+/*
+ * coordinate_students - Grade the students' directory with workers and write results.csv.
+ *
+ * Parameters:
+ *   const char* addr - Address to listen on.
+ *   int local_workers - Number of worker processes to fork on this machine (0 to wait for remote ones).
+ *   char conf[][MAX_LEN] - Configuration data.
+ *   Compiler* cc - Compiler settings given to local workers.
+ *
+ * Returns:
+ *   0 - Success.
+ *   GEN_ERROR - Setup failed, or every local worker died before the work was done.
+ */
+int coordinate_students(const char *addr, int local_workers, char conf[][MAX_LEN], Compiler *cc);
+
+/*
+ * work_for - Connect to a coordinator and grade the shards it sends until it says bye.
+ *
+ * Parameters:
+ *   const char* addr - Address of the coordinator.
+ *   char conf[][MAX_LEN] - Configuration data.
+ *   Compiler* cc - Compiler settings, initialized by the worker itself.
+ *
+ * Returns:
+ *   0 - Success.
+ *   GEN_ERROR - The connection failed.
+ */
+int work_for(const char *addr, char conf[][MAX_LEN], Compiler *cc);
+
+#endif // SHARD_H
@@ -0,0 +1,398 @@
+/*
+ * File: Watch.c
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  Watch mode of the grader based on inotify.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "Watch.h"
+#include "Results.h"
+
+#define STUDENTS_MASK (IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF | IN_ONLYDIR)
+#define STUDENT_MASK (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_ONLYDIR)
+#define IO_MASK (IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF)
+
+
+// Set by SIGINT and SIGTERM.
+static volatile sig_atomic_t stop = 0;
+
+static void stop_handler(int sig)
+{
+    stop = 1;
+}
+
+
+/*
+ * now_ms - Monotonic time in milliseconds.
+ */
+static long now_ms()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000L + t.tv_nsec / 1000000;
+}
+
+
+/*
+ * Watch_State - Everything the watch loop needs.
+ *  - fd: inotify file descriptor.
+ *  - root_wd: Watch of the students' directory.
+ *  - io_wd: Watches of the input and correct output files.
+ *  - io_version: Incremented every time the input or correct output changes.
+ *  - students, n, cap: Array of known students.
+ *  - results: Verdicts written to results.csv.
+ */
+typedef struct
+{
+    int fd;
+    int root_wd;
+    int io_wd[2];
+    int io_version;
+    Student *students;
+    int n;
+    int cap;
+    Results results;
+} Watch_State;
+
+
+/*
+ * find_student - Find a student by name, NULL if it is unknown.
+ */
+static Student *find_student(Watch_State *w, const char *name)
+{
+    for (int i = 0; i < w->n; i++)
+    {
+        if (strcmp(w->students[i].name, name) == 0)
+            return &w->students[i];
+    }
+    return NULL;
+}
+
+
+/*
+ * find_student_wd - Find a student by the watch descriptor of its directory, NULL if it is unknown.
+ */
+static Student *find_student_wd(Watch_State *w, int wd)
+{
+    for (int i = 0; i < w->n; i++)
+    {
+        if (w->students[i].wd == wd)
+            return &w->students[i];
+    }
+    return NULL;
+}
+
+
+/*
+ * add_student - Start watching the student's directory and queue it for grading.
+ */
+static void add_student(Watch_State *w, const char *students_dir, const char *name)
+{
+    Student *s = find_student(w, name);
+    if (s == NULL)
+    {
+        if (w->n == w->cap)
+        {
+            w->cap = w->cap ? w->cap * 2 : 64;
+            w->students = (Student *)realloc(w->students, w->cap * sizeof(Student));
+            if (w->students == NULL)
+            {
+                printf("Error! Memory allocating\n");
+                exit(GEN_ERROR);
+            }
+        }
+        s = &w->students[w->n++];
+        memset(s, 0, sizeof(Student));
+        strncpy(s->name, name, MAX_LEN - 1);
+        s->wd = -1;
+    }
+
+    char path[MAX_LEN * 2];
+    snprintf(path, sizeof(path), "%s/%s", students_dir, name);
+    if (s->wd < 0)
+    {
+        s->wd = inotify_add_watch(w->fd, path, STUDENT_MASK);
+        if (s->wd < 0)
+            perror("Error in: inotify_add_watch");
+    }
+    s->dirty = 1;
+}
+
+
+/*
+ * remove_student - Forget a student whose directory was removed.
+ */
+static void remove_student(Watch_State *w, const char *name)
+{
+    Student *s = find_student(w, name);
+    if (s == NULL)
+        return;
+    if (s->wd >= 0)
+        inotify_rm_watch(w->fd, s->wd);
+    results_remove(&w->results, name);
+    *s = w->students[--w->n];
+}
+
+
+/*
+ * scan_students - Queue every directory in the students' directory.
+ */
+static void scan_students(Watch_State *w, const char *students_dir)
+{
+    DIR *pDir = opendir(students_dir);
+    struct dirent *pDirent;
+    if (pDir == NULL)
+    {
+        perror("Error in: opendir");
+        return;
+    }
+    while ((pDirent = readdir(pDir)) != NULL)
+    {
+        if (pDirent->d_type == DT_DIR && strcmp(pDirent->d_name, ".") != 0 && strcmp(pDirent->d_name, "..") != 0)
+            add_student(w, students_dir, pDirent->d_name);
+    }
+    closedir(pDir);
+}
+
+
+/*
+ * is_executable_name - Executables are created and deleted by the grader itself, their events are ignored.
+ */
+static int is_executable_name(const char *name)
+{
+    int n = strlen(name);
+    return n >= 4 && strcmp(name + n - 4, ".out") == 0;
+}
+
+
+/*
+ * handle_events - Read all pending inotify events and queue the affected students.
+ *
+ * Returns:
+ *   1 if the table of verdicts changed without grading (a student was removed), 0 otherwise.
+ */
+static int handle_events(Watch_State *w, char conf[][MAX_LEN])
+{
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changed = 0;
+
+    while (1)
+    {
+        ssize_t len = read(w->fd, buf, sizeof(buf));
+        if (len <= 0)
+            break;
+
+        for (char *p = buf; p < buf + len; p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len)
+        {
+            struct inotify_event *ev = (struct inotify_event *)p;
+
+            // Events were lost, queue everyone again.
+            if (ev->mask & IN_Q_OVERFLOW)
+            {
+                scan_students(w, conf[0]);
+                for (int i = 0; i < w->n; i++)
+                    w->students[i].dirty = 1;
+                continue;
+            }
+
+            // Input or correct output changed, every verdict is outdated.
+            if (ev->wd == w->io_wd[0] || ev->wd == w->io_wd[1])
+            {
+                int k = ev->wd == w->io_wd[0] ? 0 : 1;
+                if (ev->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+                    w->io_wd[k] = inotify_add_watch(w->fd, conf[k + 1], IO_MASK);
+                w->io_version++;
+                for (int i = 0; i < w->n; i++)
+                    w->students[i].dirty = 1;
+                continue;
+            }
+
+            // A directory appeared or disappeared in the students' directory.
+            if (ev->wd == w->root_wd)
+            {
+                if (!(ev->mask & IN_ISDIR) || ev->len == 0)
+                    continue;
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+                    add_student(w, conf[0], ev->name);
+                else if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+                {
+                    remove_student(w, ev->name);
+                    changed = 1;
+                }
+                continue;
+            }
+
+            // Something changed inside a student's directory.
+            Student *s = find_student_wd(w, ev->wd);
+            if (s == NULL)
+                continue;
+            if (ev->mask & IN_IGNORED)
+            {
+                s->wd = -1;
+                continue;
+            }
+            if (ev->len > 0 && is_executable_name(ev->name))
+                continue;
+            s->dirty = 1;
+        }
+    }
+    return changed;
+}
+
+
+/*
+ * same_submission - Check if the student's C file, input and correct output are the ones it was graded with.
+ */
+static int same_submission(Watch_State *w, Student *s, int found, char *c_file, struct stat *st)
+{
+    if (!s->graded || s->io_version != w->io_version)
+        return 0;
+    if (!found)
+        return s->c_file[0] == '\0';
+    return strcmp(s->c_file, c_file) == 0 && s->size == st->st_size
+           && s->mtime.tv_sec == st->st_mtim.tv_sec && s->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+
+/*
+ * grade_dirty - Grade every queued student whose submission changed.
+ *
+ * Returns:
+ *   1 if a verdict changed, 0 otherwise.
+ */
+static int grade_dirty(Watch_State *w, char conf[][MAX_LEN], Compiler *cc, int errors)
+{
+    int changed = 0;
+    for (int i = 0; i < w->n && !stop; i++)
+    {
+        Student *s = &w->students[i];
+        if (!s->dirty)
+            continue;
+        s->dirty = 0;
+
+        char path[MAX_LEN];
+        char c_file[MAX_LEN];
+        struct stat st;
+        if (strlen(conf[0]) + strlen(s->name) + 2 > MAX_LEN)
+            continue;
+        sprintf(path, "%s/%s", conf[0], s->name);
+        int found = find_c_file(path, c_file);
+        if (found == GEN_ERROR)
+            continue;
+        if (found && stat(c_file, &st) != 0)
+            continue;
+        if (same_submission(w, s, found, c_file, &st))
+            continue;
+
+        int code = handle_student(path, errors, conf[1], conf[2], cc);
+
+        // Remember what was graded.
+        s->graded = 1;
+        s->io_version = w->io_version;
+        s->c_file[0] = '\0';
+        if (found)
+        {
+            strcpy(s->c_file, c_file);
+            s->size = st.st_size;
+            s->mtime = st.st_mtim;
+        }
+
+        char line[RESULT_LEN];
+        result_line(code, s->name, line);
+        printf("%s", line);
+        fflush(stdout);
+        results_set(&w->results, s->name, code);
+        changed = 1;
+    }
+    return changed;
+}
+
+
+int watch_students(char conf[][MAX_LEN], Compiler *cc, int errors)
+{
+    Watch_State w;
+    memset(&w, 0, sizeof(w));
+    results_init(&w.results);
+
+    // Stop gracefully on SIGINT and SIGTERM, poll returns with EINTR.
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stop_handler;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    w.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (w.fd < 0)
+    {
+        perror("Error in: inotify_init1");
+        return GEN_ERROR;
+    }
+    w.root_wd = inotify_add_watch(w.fd, conf[0], STUDENTS_MASK);
+    if (w.root_wd < 0)
+    {
+        perror("Error in: inotify_add_watch");
+        close(w.fd);
+        return GEN_ERROR;
+    }
+    w.io_wd[0] = inotify_add_watch(w.fd, conf[1], IO_MASK);
+    w.io_wd[1] = inotify_add_watch(w.fd, conf[2], IO_MASK);
+
+    // Everyone is graded once at start.
+    scan_students(&w, conf[0]);
+
+    struct pollfd pfd = {w.fd, POLLIN, 0};
+    int pending = 1;
+    long deadline = now_ms() + WATCH_MAX_DELAY_MS;
+    while (!stop)
+    {
+        // Wait for events. While students are queued, wait only for the quiet time,
+        // and never past the deadline set by the first queued event.
+        int timeout = -1;
+        if (pending)
+        {
+            long left = deadline - now_ms();
+            timeout = left < 0 ? 0 : left < WATCH_DEBOUNCE_MS ? (int)left : WATCH_DEBOUNCE_MS;
+        }
+        int ready = timeout == 0 ? 0 : poll(&pfd, 1, timeout);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("Error in: poll");
+            break;
+        }
+        if (ready > 0)
+        {
+            if (handle_events(&w, conf) && results_write(&w.results, "results.csv") != 0)
+                printf("Error! results.csv was not updated\n");
+            if (!pending)
+                deadline = now_ms() + WATCH_MAX_DELAY_MS;
+            pending = 1;
+            continue;
+        }
+
+        // No events for the quiet time, or the deadline passed: grade the queued students.
+        if (grade_dirty(&w, conf, cc, errors) && results_write(&w.results, "results.csv") != 0)
+            printf("Error! results.csv was not updated\n");
+        pending = 0;
+        for (int i = 0; i < w.n; i++)
+            pending |= w.students[i].dirty;
+        deadline = now_ms() + WATCH_MAX_DELAY_MS;
+    }
+
+    close(w.fd);
+    free(w.students);
+    results_destroy(&w.results);
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * File: Watch.h
+ * Author: Semyon Guretskiy
+ * Date: September 25, 2023
+ * Description:
+ *  Watch mode: a long-running grader that follows the students' directory with inotify.
+ *  Every student is graded once at start. After that only students whose directory appears
+ *  or changes are queued and graded again, and results.csv is rewritten atomically.
+ *  A student whose C file, input and correct output did not change keeps its cached verdict
+ *  without compiling or running anything. Precompiled headers stay alive for the whole run.
+ *  The correct output is still read by comp.out for every graded student, it is not kept in memory.
+ */
+
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <sys/types.h>
+#include <time.h>
+#include "GraduateStudents.h"
+
+// Quiet time after the last event before the queued students are graded.
+#define WATCH_DEBOUNCE_MS 500
+// Longest wait after the first queued event, so a steady stream of writes cannot hold grading back.
+#define WATCH_MAX_DELAY_MS 5000
+
+/*
+ * Student - State of one student in watch mode.
+ *  - name: Name of the student's directory.
+ *  - wd: inotify watch descriptor of the directory, -1 if it is not watched.
+ *  - dirty: 1 if the student is queued for grading.
+ *  - graded: 1 if the fields below describe the last grading.
+ *  - c_file: Path to the C file that was graded, empty if there was none.
+ *  - mtime, size: Modification time and size of that C file.
+ *  - io_version: Version of the input and correct output files it was graded with.
+ */
+typedef struct
+{
+    char name[MAX_LEN];
+    int wd;
+    int dirty;
+    int graded;
+    char c_file[MAX_LEN];
+    struct timespec mtime;
+    off_t size;
+    int io_version;
+} Student;
+
+/*
+ * watch_students - Grade all students and keep grading changed ones until SIGINT or SIGTERM.
+ *
+ * Parameters:
+ *   char conf[][MAX_LEN] - Configuration data: students' directory, input and correct output paths.
+ *   Compiler* cc - Compiler settings, already initialized.
+ *   int errors - File descriptor of errors.txt.
+ *
+ * Returns:
+ *   0 - Stopped by a signal.
+ *   GEN_ERROR - inotify could not be set up.
+ */
+int watch_students(char conf[][MAX_LEN], Compiler *cc, int errors);
+
+#endif // WATCH_H
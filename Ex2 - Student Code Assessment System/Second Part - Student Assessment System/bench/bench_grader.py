@@ -0,0 +1,153 @@
+"""
+File: bench_grader.py
+Description:
+    Measure the throughput of GraduateStudents on a synthetic, repeatable workload.
+    The script builds the grader with make, generates N students with generate_students.py,
+    runs a.out on them in a scratch directory and reports:
+      - students per second
+      - CPU time and CPU utilization of the whole grading process tree
+      - peak RSS of the largest process in the tree
+      - verdicts that differ from the expected ones
+
+Usage:
+    python3 bench_grader.py [--students N] [--mix kind=weight,...] [--seed S] [--option KEY=VALUE ...]
+                            [--work-dir DIR] [--keep]
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import generate_students
+
+
+GRADER_DIR = os.path.abspath(os.path.join(os.path.dirname(__file__), os.path.pardir))
+
+
+def build():
+    """
+    build - Run make in the grader directory, exit on failure.
+    """
+    try:
+        subprocess.check_call("make", cwd=GRADER_DIR, shell=True, stdout=subprocess.DEVNULL)
+    except subprocess.CalledProcessError:
+        print("Error while running 'make'")
+        sys.exit(1)
+
+
+def run_grader(work_dir, conf_path, extra_args):
+    """
+    run_grader - Run a.out from work_dir and return (wall seconds, rusage of its process tree).
+    The rusage comes from wait4 on a.out, so it holds a.out and the processes it waited for, not the make of build().
+    """
+    start = time.perf_counter()
+    proc = subprocess.Popen(["./a.out", conf_path] + extra_args, cwd=work_dir)
+    _, status, usage = os.wait4(proc.pid, 0)
+    wall = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    if proc.returncode not in (0, 255):
+        print("Warning: a.out exited with %d" % proc.returncode)
+    return wall, usage
+
+
+def read_csv(path):
+    """
+    read_csv - Read "name,grade,reason" lines into a dictionary keyed by name.
+    """
+    result = {}
+    if not os.path.exists(path):
+        return result
+    with open(path) as f:
+        for line in f:
+            parts = line.strip().split(",")
+            if len(parts) == 3:
+                result[parts[0]] = (parts[1], parts[2])
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark GraduateStudents on a synthetic workload.")
+    parser.add_argument("--students", type=int, default=1000, help="number of students (default 1000)")
+    parser.add_argument("--mix", default=generate_students.DEFAULT_MIX, help="kind=weight,...")
+    parser.add_argument("--seed", type=int, default=1, help="random seed (default 1)")
+    parser.add_argument("--huge-mb", type=int, default=16, help="output size of huge_output submissions in MB")
+    parser.add_argument("--option", action="append", default=[], help="KEY=VALUE setting added to conf.txt")
+    parser.add_argument("--work-dir", help="directory for the workload (default: a temporary directory)")
+    parser.add_argument("--keep", action="store_true", help="do not delete the workload at the end")
+    parser.add_argument("--json", action="store_true", help="print the report as JSON")
+    parser.add_argument("grader_args", nargs="*", help="extra arguments passed to a.out after conf.txt")
+    args = parser.parse_args()
+
+    if args.students <= 0:
+        parser.error("--students must be positive")
+
+    build()
+
+    work_dir = args.work_dir or tempfile.mkdtemp(prefix="grader_bench_")
+    os.makedirs(work_dir, exist_ok=True)
+    work_dir = os.path.abspath(work_dir)
+
+    try:
+        # Generate the workload and put the grader next to it.
+        gen_start = time.perf_counter()
+        conf_path = generate_students.generate(work_dir, args.students, args.mix, args.seed, args.huge_mb, args.option)
+        gen_time = time.perf_counter() - gen_start
+        for exe in ("a.out", "comp.out"):
+            shutil.copy2(os.path.join(GRADER_DIR, exe), os.path.join(work_dir, exe))
+        for old in ("results.csv", "errors.txt", "output.txt"):
+            if os.path.exists(os.path.join(work_dir, old)):
+                os.remove(os.path.join(work_dir, old))
+
+        wall, usage = run_grader(work_dir, conf_path, args.grader_args)
+
+        # Compare verdicts with the expected ones.
+        expected = read_csv(os.path.join(work_dir, "expected.csv"))
+        results = read_csv(os.path.join(work_dir, "results.csv"))
+        missing = [name for name in expected if name not in results]
+        wrong = [name for name in expected if name in results and results[name] != expected[name]]
+        reasons = {}
+        for grade, reason in results.values():
+            reasons[reason] = reasons.get(reason, 0) + 1
+
+        user = usage.ru_utime
+        system = usage.ru_stime
+        report = {
+            "students": args.students,
+            "seed": args.seed,
+            "mix": args.mix,
+            "options": args.option,
+            "generate_seconds": round(gen_time, 3),
+            "wall_seconds": round(wall, 3),
+            "students_per_second": round(args.students / wall, 2),
+            "cpu_user_seconds": round(user, 3),
+            "cpu_system_seconds": round(system, 3),
+            "cpu_utilization_percent": round(100.0 * (user + system) / wall, 1),
+            "cpus": os.cpu_count(),
+            "peak_rss_mb": round(usage.ru_maxrss / 1024.0, 1),
+            "graded": len(results),
+            "missing": len(missing),
+            "unexpected_verdicts": len(wrong),
+            "reasons": reasons,
+        }
+
+        if args.json:
+            print(json.dumps(report, indent=2))
+        else:
+            for key, value in report.items():
+                print("%-24s %s" % (key, value))
+            for name in wrong[:10]:
+                print("unexpected: %s got %s expected %s" % (name, ",".join(results[name]), ",".join(expected[name])))
+    finally:
+        if args.keep or args.work_dir:
+            print("Workload kept in %s" % work_dir, file=sys.stderr)
+        else:
+            shutil.rmtree(work_dir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,213 @@
+"""
+File: generate_students.py
+Description:
+    Generate a synthetic students directory for benchmarking GraduateStudents.
+    Every student gets a directory whose name ends with the kind of submission it holds,
+    so the expected verdict of each student is known in advance.
+    Next to the students directory the generator writes:
+      - input.txt: input given to every submission
+      - correct_output.txt: expected output for input.txt
+      - conf.txt: configuration file for GraduateStudents, followed by the given KEY=VALUE settings
+      - expected.csv: expected "name,grade,reason" line for every student
+
+Usage:
+    python3 generate_students.py OUT_DIR [--students N] [--mix kind=weight,...] [--seed S] [--option KEY=VALUE ...]
+"""
+
+import argparse
+import os
+import random
+
+
+# Every kind of submission, its expected grade and reason in results.csv.
+KINDS = {
+    "excellent": (100, "EXCELLENT"),
+    "similar": (75, "SIMILAR"),
+    "wrong": (50, "WRONG"),
+    "compile_error": (10, "COMPILATION_ERROR"),
+    "timeout": (20, "TIMEOUT"),
+    "no_c_file": (0, "NO_C_FILE"),
+    "huge_output": (50, "WRONG"),
+}
+
+DEFAULT_MIX = "excellent=50,similar=10,wrong=15,compile_error=10,timeout=1,no_c_file=10,huge_output=4"
+
+PROMPT = "Please enter two numbers"
+
+# Sources of the submissions. "{lines}" is only used by huge_output.
+SOURCES = {
+    "excellent": """#include <stdio.h>
+
+int main()
+{
+    int n1, n2;
+    printf("%s\\n");
+    scanf("%%d %%d", &n1, &n2);
+    printf("%%d\\n", n1 + n2);
+    return 0;
+}
+""" % PROMPT,
+    "similar": """#include <stdio.h>
+
+int main()
+{
+    int n1, n2;
+    printf("%s  \\n\\n");
+    scanf("%%d %%d", &n1, &n2);
+    printf("  %%d", n1 + n2);
+    return 0;
+}
+""" % PROMPT.upper(),
+    "wrong": """#include <stdio.h>
+
+int main()
+{
+    int n1, n2;
+    printf("%s\\n");
+    scanf("%%d %%d", &n1, &n2);
+    printf("%%d\\n", n1 - n2 + 1);
+    return 0;
+}
+""" % PROMPT,
+    "compile_error": """#include <stdio.h>
+
+int main()
+{
+    printf("dfg");
+""",
+    "timeout": """#include <unistd.h>
+
+int main()
+{
+    sleep(8);
+    return 0;
+}
+""",
+    "huge_output": """#include <stdio.h>
+
+int main()
+{
+    long i;
+    for (i = 0; i < {lines}L; i++)
+        printf("%s %%ld\\n", i);
+    return 0;
+}
+""" % PROMPT,
+}
+
+
+def parse_mix(mix):
+    """
+    parse_mix - Parse "kind=weight,..." into a dictionary of weights.
+    Unknown kinds and negative weights are rejected.
+    """
+    weights = {}
+    for item in mix.split(","):
+        if not item:
+            continue
+        kind, _, weight = item.partition("=")
+        kind = kind.strip()
+        if kind not in KINDS:
+            raise ValueError("unknown submission kind: %s" % kind)
+        weights[kind] = float(weight)
+        if weights[kind] < 0:
+            raise ValueError("negative weight for %s" % kind)
+    if sum(weights.values()) <= 0:
+        raise ValueError("mix must contain at least one positive weight")
+    return weights
+
+
+def split_counts(n, weights):
+    """
+    split_counts - Split n students between kinds proportionally to the weights.
+    Remainders are handed out by largest fraction, so the counts always sum to n.
+    """
+    total = sum(weights.values())
+    exact = {k: n * w / total for k, w in weights.items()}
+    counts = {k: int(v) for k, v in exact.items()}
+    left = n - sum(counts.values())
+    for k in sorted(exact, key=lambda k: exact[k] - counts[k], reverse=True)[:left]:
+        counts[k] += 1
+    return counts
+
+
+def write_file(path, content):
+    with open(path, "w") as f:
+        f.write(content)
+
+
+def add_junk(rng, student_dir):
+    """
+    add_junk - Add files that must be ignored by the grader, like the ones in the students/ fixture.
+    """
+    for j in range(rng.randint(0, 3)):
+        name = rng.choice(["junk%d.txt", "notes%d.c.txt", "data%d.txt.c.txt"]) % j
+        write_file(os.path.join(student_dir, name), "junk\n")
+
+
+def generate(out_dir, n_students, mix=DEFAULT_MIX, seed=1, huge_mb=16, options=()):
+    """
+    generate - Create the workload in out_dir and return the path of its conf.txt.
+    The same arguments always produce the same workload.
+    """
+    rng = random.Random(seed)
+    counts = split_counts(n_students, parse_mix(mix))
+
+    kinds = []
+    for kind in sorted(counts):
+        kinds += [kind] * counts[kind]
+    rng.shuffle(kinds)
+
+    out_dir = os.path.abspath(out_dir)
+    students_dir = os.path.join(out_dir, "students")
+    os.makedirs(students_dir, exist_ok=True)
+
+    # Input and the matching expected output.
+    n1, n2 = rng.randint(0, 1000), rng.randint(0, 1000)
+    input_path = os.path.join(out_dir, "input.txt")
+    output_path = os.path.join(out_dir, "correct_output.txt")
+    write_file(input_path, "%d %d\n" % (n1, n2))
+    write_file(output_path, "%s\n%d\n" % (PROMPT, n1 + n2))
+
+    # A line of huge_output is about 35 bytes.
+    lines = max(1, huge_mb * 1024 * 1024 // 35)
+
+    expected = []
+    for i, kind in enumerate(kinds):
+        name = "student_%05d_%s" % (i, kind)
+        student_dir = os.path.join(students_dir, name)
+        os.makedirs(student_dir, exist_ok=True)
+        if kind != "no_c_file":
+            source = SOURCES[kind].replace("{lines}", str(lines))
+            write_file(os.path.join(student_dir, "main.c"), source)
+        add_junk(rng, student_dir)
+        grade, reason = KINDS[kind]
+        expected.append("%s,%d,%s\n" % (name, grade, reason))
+
+    write_file(os.path.join(out_dir, "expected.csv"), "".join(expected))
+
+    conf_path = os.path.join(out_dir, "conf.txt")
+    settings = "".join("%s\n" % option for option in options)
+    write_file(conf_path, "%s\n%s\n%s\n%s" % (students_dir, input_path, output_path, settings))
+    return conf_path
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a synthetic students directory.")
+    parser.add_argument("out_dir", help="directory to create the workload in")
+    parser.add_argument("--students", type=int, default=1000, help="number of students (default 1000)")
+    parser.add_argument("--mix", default=DEFAULT_MIX, help="kind=weight,... (default %s)" % DEFAULT_MIX)
+    parser.add_argument("--seed", type=int, default=1, help="random seed (default 1)")
+    parser.add_argument("--huge-mb", type=int, default=16, help="output size of huge_output submissions in MB")
+    parser.add_argument("--option", action="append", default=[], help="KEY=VALUE setting added to conf.txt")
+    args = parser.parse_args()
+
+    if args.students <= 0:
+        parser.error("--students must be positive")
+
+    conf = generate(args.out_dir, args.students, args.mix, args.seed, args.huge_mb, args.option)
+    print(conf)
+
+
+if __name__ == "__main__":
+    main()
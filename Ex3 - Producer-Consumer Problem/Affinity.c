@@ -0,0 +1,252 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+// cpu_set_t, sched_getaffinity and the pthread affinity functions are GNU extensions.
+#define _GNU_SOURCE
+
+#include "Affinity.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#ifndef AFFINITY_SYSFS
+#define AFFINITY_SYSFS "/sys/devices/system/cpu"
+#endif
+
+#define WORD_BITS (8 * sizeof(unsigned long))
+
+
+/*
+ * Cpu_Place - Where a CPU is: its package and its core in the package.
+ */
+typedef struct
+{
+    int cpu;
+    int package;
+    int core;
+} Cpu_Place;
+
+
+static void set_add(Cpu_Set *set, int cpu)
+{
+    set->bits[cpu / WORD_BITS] |= 1UL << (cpu % WORD_BITS);
+}
+
+
+static int set_has(const Cpu_Set *set, int cpu)
+{
+    return (set->bits[cpu / WORD_BITS] >> (cpu % WORD_BITS)) & 1;
+}
+
+
+static void to_cpu_set(const Cpu_Set *set, cpu_set_t *out)
+{
+    CPU_ZERO(out);
+    for (int cpu = 0; cpu < AFFINITY_MAX_CPUS && cpu < CPU_SETSIZE; cpu++)
+    {
+        if (set_has(set, cpu))
+            CPU_SET(cpu, out);
+    }
+}
+
+
+static void from_cpu_set(const cpu_set_t *in, Cpu_Set *set)
+{
+    memset(set, 0, sizeof(Cpu_Set));
+    for (int cpu = 0; cpu < AFFINITY_MAX_CPUS && cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, in))
+            set_add(set, cpu);
+    }
+}
+
+
+/*
+ * read_topology - Read one number of the topology of a CPU, -1 if it is not known.
+ */
+static int read_topology(int cpu, const char *name)
+{
+    char path[128];
+    snprintf(path, sizeof(path), AFFINITY_SYSFS "/cpu%d/topology/%s", cpu, name);
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return -1;
+    int value;
+    if (fscanf(f, "%d", &value) != 1)
+        value = -1;
+    fclose(f);
+    return value;
+}
+
+
+static int compare_place(const void *a, const void *b)
+{
+    const Cpu_Place *x = (const Cpu_Place *)a, *y = (const Cpu_Place *)b;
+    if (x->package != y->package)
+        return x->package - y->package;
+    if (x->core != y->core)
+        return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+
+
+int affinity_parse(const char *list, Cpu_Set *set)
+{
+    memset(set, 0, sizeof(Cpu_Set));
+    const char *p = list;
+    int any = 0;
+    while (*p != '\0')
+    {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (end == p)
+            return -1;
+        if (*end == '-')
+        {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p)
+                return -1;
+        }
+        if (first < 0 || last < first || last >= AFFINITY_MAX_CPUS)
+            return -1;
+        for (long cpu = first; cpu <= last; cpu++)
+            set_add(set, cpu);
+        any = 1;
+
+        if (*end == ',')
+            end++;
+        else if (*end != '\0')
+            return -1;
+        p = end;
+    }
+    return any ? 0 : -1;
+}
+
+
+int affinity_allowed(const Cpu_Set *set)
+{
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) != 0)
+        return 1;
+    for (int cpu = 0; cpu < AFFINITY_MAX_CPUS && cpu < CPU_SETSIZE; cpu++)
+    {
+        if (set_has(set, cpu) && CPU_ISSET(cpu, &mask))
+            return 1;
+    }
+    return 0;
+}
+
+
+int affinity_auto(Cpu_Set *sets)
+{
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) != 0 || CPU_COUNT(&mask) < 2)
+        return -1;
+
+    // Every allowed CPU with its place, an unknown place counts as a core of its own on package 0
+    Cpu_Place *places = (Cpu_Place *)malloc(CPU_COUNT(&mask) * sizeof(Cpu_Place));
+    if (places == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    int n = 0;
+    for (int cpu = 0; cpu < AFFINITY_MAX_CPUS && cpu < CPU_SETSIZE; cpu++)
+    {
+        if (!CPU_ISSET(cpu, &mask))
+            continue;
+        places[n].cpu = cpu;
+        places[n].package = read_topology(cpu, "physical_package_id");
+        places[n].core = read_topology(cpu, "core_id");
+        if (places[n].package < 0)
+            places[n].package = 0;
+        if (places[n].core < 0)
+            places[n].core = -1 - cpu;
+        n++;
+    }
+    qsort(places, n, sizeof(Cpu_Place), compare_place);
+
+    // The package with the most allowed CPUs, its CPUs are places[start .. start + count)
+    int start = 0, count = 0;
+    for (int i = 0, j; i < n; i = j)
+    {
+        for (j = i; j < n && places[j].package == places[i].package; j++)
+            ;
+        if (j - i > count)
+        {
+            start = i;
+            count = j - i;
+        }
+    }
+
+    // Split the package into cores
+    int *cores = (int *)malloc((count + 1) * sizeof(int));
+    if (cores == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    int n_cores = 0;
+    for (int i = start; i < start + count; i++)
+    {
+        if (i == start || places[i].core != places[i - 1].core)
+            cores[n_cores++] = i;
+    }
+    cores[n_cores] = start + count;
+
+    // Dispatchers on the first core, the screen manager on the next, the editors on the rest
+    int first[N_STAGES], last[N_STAGES];
+    first[STAGE_PRODUCER] = 0;
+    last[STAGE_PRODUCER] = n_cores;
+    first[STAGE_DISPATCHER] = 0;
+    last[STAGE_DISPATCHER] = 1;
+    first[STAGE_SCREEN] = n_cores > 1 ? 1 : 0;
+    last[STAGE_SCREEN] = first[STAGE_SCREEN] + 1;
+    first[STAGE_EDITOR] = n_cores > 2 ? 2 : first[STAGE_SCREEN];
+    last[STAGE_EDITOR] = n_cores > 2 ? n_cores : last[STAGE_SCREEN];
+    for (int s = 0; s < N_STAGES; s++)
+    {
+        memset(&sets[s], 0, sizeof(Cpu_Set));
+        for (int i = cores[first[s]]; i < cores[last[s]]; i++)
+            set_add(&sets[s], places[i].cpu);
+    }
+
+    free(cores);
+    free(places);
+    return 0;
+}
+
+
+void affinity_attr(pthread_attr_t *attr, const Cpu_Set *set)
+{
+    cpu_set_t mask;
+    to_cpu_set(set, &mask);
+    pthread_attr_setaffinity_np(attr, sizeof(mask), &mask);
+}
+
+
+void affinity_enter(const Cpu_Set *set, Cpu_Set *home)
+{
+    if (set == NULL)
+        return;
+    cpu_set_t mask;
+    pthread_getaffinity_np(pthread_self(), sizeof(mask), &mask);
+    from_cpu_set(&mask, home);
+    to_cpu_set(set, &mask);
+    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+}
+
+
+void affinity_leave(const Cpu_Set *set, const Cpu_Set *home)
+{
+    if (set == NULL)
+        return;
+    cpu_set_t mask;
+    to_cpu_set(home, &mask);
+    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+}
@@ -0,0 +1,101 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_AFFINITY_H
+#define EX3_AFFINITY_H
+
+#include "News.h"
+#include <pthread.h>
+
+#define AFFINITY_MAX_CPUS 1024
+#define AFFINITY_WORDS (AFFINITY_MAX_CPUS / (8 * sizeof(unsigned long)))
+
+
+/*
+ * Struct: Cpu_Set
+ * Description: Set of CPUs a stage runs on, one bit per CPU number.
+ * Kept apart from cpu_set_t, which only exists with _GNU_SOURCE.
+ */
+typedef struct
+{
+    unsigned long bits[AFFINITY_WORDS];
+} Cpu_Set;
+
+
+/*
+ * affinity_parse - Parse a CPU list such as "0-3,8,10-11".
+ *
+ * Parameters:
+ *  const char* list - The CPU list.
+ *  Cpu_Set* set - Receives the CPUs.
+ *
+ * Return:
+ *  int - 0 on success, -1 if the list is invalid or empty.
+ */
+int affinity_parse(const char *list, Cpu_Set *set);
+
+
+/*
+ * affinity_allowed - Check that a set has a CPU the process may run on.
+ *
+ * Parameters:
+ *  const Cpu_Set* set - The CPUs.
+ *
+ * Return:
+ *  int - 1 if it has one, 0 otherwise.
+ */
+int affinity_allowed(const Cpu_Set *set);
+
+
+/*
+ * affinity_auto - Place the stages on the CPUs the process may run on, communicating stages close together.
+ *
+ * Every stage stays on the package (socket) with the most allowed CPUs, so the queues between the stages
+ * stay in one last-level cache and NUMA node. The CPUs are taken core by core, with the SMT siblings of a
+ * core next to each other: the dispatchers get the first core, the screen manager the next one, the editors
+ * the other cores, and the producers every CPU of the package. A stage without a core of its own shares
+ * the ones before it.
+ *
+ * Parameters:
+ *  Cpu_Set* sets - Receives the CPUs of every STAGE, N_STAGES of them.
+ *
+ * Return:
+ *  int - 0 on success, -1 if the process may run on a single CPU only, there is nothing to place then.
+ */
+int affinity_auto(Cpu_Set *sets);
+
+
+/*
+ * affinity_attr - Make the threads created with a thread attribute run on a set of CPUs.
+ *
+ * Parameters:
+ *  pthread_attr_t* attr - The attribute.
+ *  const Cpu_Set* set - The CPUs.
+ */
+void affinity_attr(pthread_attr_t *attr, const Cpu_Set *set);
+
+
+/*
+ * affinity_enter - Move the calling thread to a set of CPUs until affinity_leave.
+ * Memory the thread touches first in between is placed on the NUMA node of these CPUs.
+ *
+ * Parameters:
+ *  const Cpu_Set* set - The CPUs, NULL to stay where the thread is.
+ *  Cpu_Set* home - Receives the CPUs of the thread before the call.
+ */
+void affinity_enter(const Cpu_Set *set, Cpu_Set *home);
+
+
+/*
+ * affinity_leave - Move the calling thread back to the CPUs saved by affinity_enter.
+ *
+ * Parameters:
+ *  const Cpu_Set* set - The set passed to affinity_enter.
+ *  const Cpu_Set* home - The CPUs saved by affinity_enter.
+ */
+void affinity_leave(const Cpu_Set *set, const Cpu_Set *home);
+
+
+#endif //EX3_AFFINITY_H
@@ -0,0 +1,268 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Channel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+int queue_kind(const char *name)
+{
+    if (strcmp(name, "bounded") == 0)
+        return QUEUE_BOUNDED;
+    if (strcmp(name, "spsc") == 0)
+        return QUEUE_SPSC;
+    if (strcmp(name, "mpsc") == 0)
+        return QUEUE_MPSC;
+    if (strcmp(name, "unbounded") == 0)
+        return QUEUE_UNBOUNDED;
+    if (strcmp(name, "chunked") == 0)
+        return QUEUE_CHUNKED;
+    if (strcmp(name, "padded") == 0)
+        return QUEUE_PADDED;
+    return -1;
+}
+
+
+Channel *create_channel(int kind, int size)
+{
+    Channel *c = (Channel *)malloc(sizeof(Channel));
+    if (c == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    c->kind = kind;
+    c->ready = NULL;
+    c->ready_id = 0;
+    switch (kind) {
+        case QUEUE_SPSC:
+            c->s = create_queue_s(size);
+            break;
+        case QUEUE_MPSC:
+            c->m = create_queue_m(size);
+            break;
+        case QUEUE_UNBOUNDED:
+            c->u = create_queue_u();
+            break;
+        case QUEUE_CHUNKED:
+            c->c = create_queue_c();
+            break;
+        case QUEUE_PADDED:
+            c->p = create_queue_p(size);
+            break;
+        default:
+            c->kind = QUEUE_BOUNDED;
+            c->b = create_queue_b(size);
+            break;
+    }
+    return c;
+}
+
+
+void channel_put(Channel *c, Item n)
+{
+    switch (c->kind) {
+        case QUEUE_SPSC:
+            enqueue_s(c->s, n);
+            break;
+        case QUEUE_MPSC:
+            enqueue_m(c->m, n);
+            break;
+        case QUEUE_UNBOUNDED:
+            enqueue_u_news(c->u, n);
+            break;
+        case QUEUE_CHUNKED:
+            enqueue_c_mut(c->c, n);
+            break;
+        case QUEUE_PADDED:
+            enqueue_p(c->p, n);
+            break;
+        default:
+            enqueue_b_mut(c->b, n);
+            break;
+    }
+    if (c->ready != NULL)
+        ready_mark(c->ready, c->ready_id);
+}
+
+
+void channel_put_many(Channel *c, Item *news, int n)
+{
+    int done = 0;
+    switch (c->kind) {
+        case QUEUE_UNBOUNDED:
+            enqueue_u_news_many(c->u, news, n);
+            break;
+        case QUEUE_CHUNKED:
+            enqueue_c_many(c->c, news, n);
+            break;
+        case QUEUE_BOUNDED:
+            // Each call moves as many as there are free slots.
+            while (done < n)
+                done += enqueue_b_many(c->b, news + done, n - done);
+            break;
+        case QUEUE_PADDED:
+            while (done < n)
+                done += enqueue_p_many(c->p, news + done, n - done);
+            break;
+        default:
+            for (; done < n; done++)
+                channel_put(c, news[done]);
+            return;
+    }
+    if (c->ready != NULL && n > 0)
+        ready_mark(c->ready, c->ready_id);
+}
+
+
+Item channel_get(Channel *c)
+{
+    switch (c->kind) {
+        case QUEUE_SPSC:
+            return dequeue_s(c->s);
+        case QUEUE_MPSC:
+            return dequeue_m(c->m);
+        case QUEUE_UNBOUNDED:
+            return dequeue_u_mut(c->u);
+        case QUEUE_CHUNKED:
+            return dequeue_c_mut(c->c);
+        case QUEUE_PADDED:
+            return dequeue_p(c->p);
+        default:
+            return dequeue_b_mut(c->b);
+    }
+}
+
+
+int channel_try_get(Channel *c, Item *out)
+{
+    switch (c->kind) {
+        case QUEUE_SPSC:
+            return try_dequeue_s(c->s, out);
+        case QUEUE_MPSC:
+            return try_dequeue_m(c->m, out);
+        case QUEUE_UNBOUNDED:
+            return try_dequeue_u_mut(c->u, out);
+        case QUEUE_CHUNKED:
+            return try_dequeue_c_mut(c->c, out);
+        case QUEUE_PADDED:
+            return try_dequeue_p(c->p, out);
+        default:
+            return try_dequeue_b_mut(c->b, out);
+    }
+}
+
+
+int channel_get_until(Channel *c, Item *out, const struct timespec *deadline)
+{
+    if (deadline == NULL)
+    {
+        *out = channel_get(c);
+        return 0;
+    }
+    switch (c->kind) {
+        case QUEUE_UNBOUNDED:
+            return dequeue_u_until(c->u, out, deadline);
+        case QUEUE_CHUNKED:
+            return dequeue_c_until(c->c, out, deadline);
+        default:
+            return channel_try_get(c, out);
+    }
+}
+
+
+int channel_get_many(Channel *c, Item *out, int max)
+{
+    if (c->kind == QUEUE_BOUNDED)
+        return dequeue_b_many(c->b, out, max);
+    if (c->kind == QUEUE_UNBOUNDED)
+        return dequeue_u_many(c->u, out, max);
+    if (c->kind == QUEUE_CHUNKED)
+        return dequeue_c_many(c->c, out, max);
+    if (c->kind == QUEUE_PADDED)
+        return dequeue_p_many(c->p, out, max);
+
+    // The lock-free queues need no lock to amortize: wait for one, then take what is ready.
+    out[0] = channel_get(c);
+    return 1 + channel_try_get_many(c, out + 1, max - 1);
+}
+
+
+int channel_try_get_many(Channel *c, Item *out, int max)
+{
+    if (c->kind == QUEUE_BOUNDED)
+        return try_dequeue_b_many(c->b, out, max);
+    if (c->kind == QUEUE_PADDED)
+        return try_dequeue_p_many(c->p, out, max);
+
+    int count = 0;
+    while (count < max && channel_try_get(c, &out[count]) == 0)
+        count++;
+    return count;
+}
+
+
+void channel_watch(Channel *c, Ready_Set *r, int id)
+{
+    c->ready = r;
+    c->ready_id = id;
+}
+
+
+int channel_depth(Channel *c)
+{
+    int n = 0;
+    switch (c->kind) {
+        case QUEUE_SPSC:
+            return atomic_load_explicit(&c->s->tail, memory_order_relaxed)
+                   - atomic_load_explicit(&c->s->head, memory_order_relaxed);
+        case QUEUE_MPSC:
+            // 'head' belongs to the consumer, read it without a data race.
+            return atomic_load_explicit(&c->m->tail, memory_order_relaxed)
+                   - __atomic_load_n(&c->m->head, __ATOMIC_RELAXED);
+        case QUEUE_UNBOUNDED:
+            sem_getvalue(&c->u->full, &n);
+            break;
+        case QUEUE_CHUNKED:
+            sem_getvalue(&c->c->full, &n);
+            break;
+        case QUEUE_PADDED:
+            sem_getvalue(&c->p->full, &n);
+            break;
+        default:
+            sem_getvalue(&c->b->full, &n);
+            break;
+    }
+    return n;
+}
+
+
+void delete_channel(Channel *c)
+{
+    switch (c->kind) {
+        case QUEUE_SPSC:
+            delete_queue_s(c->s);
+            break;
+        case QUEUE_MPSC:
+            delete_queue_m(c->m);
+            break;
+        case QUEUE_UNBOUNDED:
+            delete_queue_u(c->u);
+            break;
+        case QUEUE_CHUNKED:
+            delete_queue_c(c->c);
+            break;
+        case QUEUE_PADDED:
+            delete_queue_p(c->p);
+            break;
+        default:
+            delete_queue_b(c->b);
+            break;
+    }
+    free(c);
+}
@@ -0,0 +1,207 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_CHANNEL_H
+#define EX3_CHANNEL_H
+
+#include "News.h"
+#include "Queue_B.h"
+#include "Queue_S.h"
+#include "Queue_M.h"
+#include "Queue_U.h"
+#include "Queue_C.h"
+#include "Queue_P.h"
+#include "Ready.h"
+
+
+/*
+ * Queue implementations a channel can use.
+ *  - QUEUE_BOUNDED: Queue_B, semaphores and a mutex. Any number of producers and consumers.
+ *  - QUEUE_SPSC: Queue_S, lock-free ring buffer. One producer thread and one consumer thread.
+ *  - QUEUE_MPSC: Queue_M, lock-free sequence-numbered slots. Any number of producers, one consumer thread.
+ *  - QUEUE_UNBOUNDED: Queue_U, linked list of recycled nodes. Never full, the size is ignored.
+ *  - QUEUE_CHUNKED: Queue_C, linked segments of SEGMENT_SIZE slots. Never full, the size is ignored.
+ *  - QUEUE_PADDED: Queue_P, Queue_B with separate producer and consumer locks on their own cache lines.
+ */
+enum QUEUE_KIND {
+    QUEUE_BOUNDED,
+    QUEUE_SPSC,
+    QUEUE_MPSC,
+    QUEUE_UNBOUNDED,
+    QUEUE_CHUNKED,
+    QUEUE_PADDED
+};
+
+
+/*
+ * Channel - A queue between two stages of the pipeline.
+ *
+ * The stages only use the channel functions, so the queue implementation
+ * of every channel is selected by the configuration.
+ * A channel watched by a Ready_Set marks its bit there after every put.
+ */
+typedef struct {
+    int kind;
+    Ready_Set *ready;
+    int ready_id;
+    union {
+        Queue_B *b;
+        Queue_S *s;
+        Queue_M *m;
+        Queue_U *u;
+        Queue_C *c;
+        Queue_P *p;
+    };
+} Channel;
+
+
+/*
+ * queue_kind - Parse the name of a queue implementation.
+ *
+ * Parameters:
+ *  const char* name - "bounded", "spsc", "mpsc", "unbounded", "chunked" or "padded".
+ *
+ * Return:
+ *  int - The QUEUE_KIND, or -1 if the name is unknown.
+ */
+int queue_kind(const char *name);
+
+
+/*
+ * create_channel - Create a channel with the given queue implementation.
+ *
+ * Parameters:
+ *  int kind - QUEUE_KIND of the queue.
+ *  int size - Capacity of the queue.
+ *
+ * Return:
+ *  Channel* - Pointer to the newly created channel.
+ */
+Channel *create_channel(int kind, int size);
+
+
+/*
+ * channel_put - Put a news item into the channel, waiting while it is full.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ *  Item n - The news item.
+ */
+void channel_put(Channel *c, Item n);
+
+
+/*
+ * channel_put_many - Put several news items into the channel, in order, waiting while it is full.
+ * The unbounded and bounded queues take them under a single lock acquisition.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ *  Item* news - News items to put.
+ *  int n - Number of news items.
+ */
+void channel_put_many(Channel *c, Item *news, int n);
+
+
+/*
+ * channel_get - Take a news item from the channel, waiting while it is empty.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ *
+ * Return:
+ *  Item - The news item.
+ */
+Item channel_get(Channel *c);
+
+
+/*
+ * channel_try_get - Take a news item from the channel without waiting.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ *  Item* out - Receives the news item.
+ *
+ * Return:
+ *  int - 0 on success, -1 if the channel is empty.
+ */
+int channel_try_get(Channel *c, Item *out);
+
+
+/*
+ * channel_get_until - Take a news item from the channel, waiting until the deadline at the latest.
+ * Only the editor queue kinds (QUEUE_UNBOUNDED, QUEUE_CHUNKED) wait, the other kinds behave like channel_try_get.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ *  Item* out - Receives the news item.
+ *  const struct timespec* deadline - Absolute CLOCK_REALTIME time, NULL to wait without a limit.
+ *
+ * Return:
+ *  int - 0 on success, -1 if nothing came before the deadline.
+ */
+int channel_get_until(Channel *c, Item *out, const struct timespec *deadline);
+
+
+/*
+ * channel_get_many - Take up to max news items from the channel, waiting while it is empty.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ *  Item* out - Array that receives the news items, in order.
+ *  int max - Size of 'out'.
+ *
+ * Return:
+ *  int - Number of news items taken, at least 1.
+ */
+int channel_get_many(Channel *c, Item *out, int max);
+
+
+/*
+ * channel_try_get_many - Take up to max news items from the channel without waiting.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ *  Item* out - Array that receives the news items, in order.
+ *  int max - Size of 'out'.
+ *
+ * Return:
+ *  int - Number of news items taken, 0 if the channel is empty.
+ */
+int channel_try_get_many(Channel *c, Item *out, int max);
+
+
+/*
+ * channel_watch - Mark the channel in a readiness set after every put.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ *  Ready_Set* r - Readiness set of the consumer.
+ *  int id - Index of the channel in the set.
+ */
+void channel_watch(Channel *c, Ready_Set *r, int id);
+
+
+/*
+ * channel_depth - Number of news items in the channel. Any thread, the value may be stale at once.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ *
+ * Return:
+ *  int - Number of items.
+ */
+int channel_depth(Channel *c);
+
+
+/*
+ * delete_channel - Delete a channel and its queue.
+ *
+ * Parameters:
+ *  Channel* c - Pointer to the channel.
+ */
+void delete_channel(Channel *c);
+
+
+#endif //EX3_CHANNEL_H
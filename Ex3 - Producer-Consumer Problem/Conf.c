@@ -0,0 +1,353 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Conf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+Conf* read_conf(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        exit(1);
+    }
+
+    Conf* conf = (Conf*) malloc(sizeof (Conf));
+    if (conf == NULL) {
+        exit(1);
+    }
+    conf->prod_queue = QUEUE_BOUNDED;
+    conf->sm_queue = QUEUE_BOUNDED;
+    conf->edit_queue = QUEUE_UNBOUNDED;
+    conf->batch = DEFAULT_BATCH;
+    conf->edit_mode = EDIT_CATEGORY;
+    conf->editing = EDITING_SLEEP;
+    conf->runtime = RUNTIME_THREADS;
+    conf->flush_ms = DEFAULT_FLUSH_MS;
+    conf->dispatchers = 1;
+    conf->seed = (uint64_t) time(NULL);
+    strcpy(conf->telemetry, "off");
+    conf->affinity = AFFINITY_OFF;
+    conf->queue_numa = 0;
+    conf->priority_age = DEFAULT_PRIORITY_AGE;
+    conf->prioritized = 0;
+    for (int c = 0; c < N_CO_EDIT; c++) {
+        conf->editors[c] = 1;
+        conf->edit_ms[c] = DEFAULT_EDIT_MS;
+        conf->priority[c] = PRIORITY_LEVELS - 1;
+    }
+    for (int s = 0; s < N_STAGES; s++)
+        conf->has_cpus[s] = 0;
+
+    Prod_Conf* arguments = NULL;
+    int objectCount = 0;
+    int maxObjects = 0;
+
+    Prod_Conf temp_arg;
+
+    // Read regular arguments
+    while (fscanf(file, "%d", &temp_arg.prod_id) == 1
+           && fscanf(file, "%d", &temp_arg.n_news) == 1
+           && fscanf(file, "%d", &temp_arg.q_size) == 1){
+
+
+        if (objectCount >= maxObjects) {
+            maxObjects += 5;
+            Prod_Conf* newObjects = realloc(arguments, maxObjects * sizeof(Prod_Conf));
+            if (newObjects == NULL) {
+                exit(1);
+            }
+            arguments = newObjects;
+        }
+
+
+        arguments[objectCount] = temp_arg;
+        arguments[objectCount].priority = PRIORITY_LEVELS - 1;
+        objectCount++;
+    }
+
+    // The options may refer to the producers
+    conf->prodArg = arguments;
+    conf->n_pr = objectCount;
+
+    // Read optional settings
+    char key[MAX_OPTION], value[MAX_OPTION];
+    while (fscanf(file, "%63s %63s", key, value) == 2) {
+        if (conf_option(conf, key, value) != 0)
+            exit(1);
+    }
+
+    if (!feof(file) || ferror(file))
+        exit(1);
+
+    fclose(file);
+
+    conf->sm_q_size = temp_arg.prod_id;
+
+    return conf;
+}
+
+
+int conf_option(Conf *conf, const char *key, const char *value) {
+    if (strcmp(key, "PRODUCER_QUEUE") == 0) {
+        conf->prod_queue = queue_kind(value);
+        if (conf->prod_queue < 0) {
+            printf("Unknown queue %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    // Every co-editor writes to the shared queue, a single-producer queue cannot be used.
+    if (strcmp(key, "SHARED_QUEUE") == 0) {
+        conf->sm_queue = queue_kind(value);
+        if (conf->sm_queue < 0 || conf->sm_queue == QUEUE_SPSC) {
+            printf("Unknown queue %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    // The editor queues are unbounded.
+    if (strcmp(key, "EDITOR_QUEUE") == 0) {
+        conf->edit_queue = queue_kind(value);
+        if (conf->edit_queue != QUEUE_UNBOUNDED && conf->edit_queue != QUEUE_CHUNKED) {
+            printf("Unknown queue %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    // Number of editors of every category, or of one category.
+    const char *categories[N_CO_EDIT] = {"SPORT_EDITORS", "NEWS_EDITORS", "WEATHER_EDITORS"};
+    for (int c = 0; c < N_CO_EDIT; c++) {
+        if (strcmp(key, "EDITORS") == 0 || strcmp(key, categories[c]) == 0) {
+            int n = atoi(value);
+            if (n < 1) {
+                printf("Wrong number of editors %s\n", value);
+                return -1;
+            }
+            for (int k = 0; k < N_CO_EDIT; k++) {
+                if (k == c || strcmp(key, "EDITORS") == 0)
+                    conf->editors[k] = n;
+            }
+            return 0;
+        }
+    }
+
+    // Edit latency of every category, or of one category.
+    const char *latencies[N_CO_EDIT] = {"SPORT_EDIT_MS", "NEWS_EDIT_MS", "WEATHER_EDIT_MS"};
+    for (int c = 0; c < N_CO_EDIT; c++) {
+        if (strcmp(key, "EDIT_MS") == 0 || strcmp(key, latencies[c]) == 0) {
+            int ms = atoi(value);
+            if (ms < 0 || (ms == 0 && strcmp(value, "0") != 0)) {
+                printf("Wrong edit latency %s\n", value);
+                return -1;
+            }
+            for (int k = 0; k < N_CO_EDIT; k++) {
+                if (k == c || strcmp(key, "EDIT_MS") == 0)
+                    conf->edit_ms[k] = ms;
+            }
+            return 0;
+        }
+    }
+
+    if (strcmp(key, "BATCH") == 0) {
+        conf->batch = atoi(value);
+        if (conf->batch < 1) {
+            printf("Wrong batch size %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "EDIT_MODE") == 0) {
+        if (strcmp(value, "category") == 0)
+            conf->edit_mode = EDIT_CATEGORY;
+        else if (strcmp(value, "steal") == 0)
+            conf->edit_mode = EDIT_STEAL;
+        else {
+            printf("Unknown edit mode %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "EDITING") == 0) {
+        if (strcmp(value, "sleep") == 0)
+            conf->editing = EDITING_SLEEP;
+        else if (strcmp(value, "timer") == 0)
+            conf->editing = EDITING_TIMER;
+        else {
+            printf("Unknown editing %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "RUNTIME") == 0) {
+        if (strcmp(value, "threads") == 0)
+            conf->runtime = RUNTIME_THREADS;
+        else if (strcmp(value, "coroutines") == 0)
+            conf->runtime = RUNTIME_COROUTINES;
+        else {
+            printf("Unknown runtime %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "FLUSH_MS") == 0) {
+        conf->flush_ms = atoi(value);
+        if (conf->flush_ms < 0 || (conf->flush_ms == 0 && strcmp(value, "0") != 0)) {
+            printf("Wrong flush interval %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "DISPATCHERS") == 0) {
+        conf->dispatchers = atoi(value);
+        if (conf->dispatchers < 1) {
+            printf("Wrong number of dispatchers %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "AFFINITY") == 0) {
+        if (strcmp(value, "off") == 0)
+            conf->affinity = AFFINITY_OFF;
+        else if (strcmp(value, "auto") == 0)
+            conf->affinity = AFFINITY_AUTO;
+        else {
+            printf("Unknown affinity %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    // CPU list of one stage.
+    const char *stages[N_STAGES] = {"PRODUCER_CPUS", "DISPATCHER_CPUS", "EDITOR_CPUS", "SCREEN_CPUS"};
+    for (int s = 0; s < N_STAGES; s++) {
+        if (strcmp(key, stages[s]) == 0) {
+            if (affinity_parse(value, &conf->cpus[s]) != 0 || !affinity_allowed(&conf->cpus[s])) {
+                printf("Wrong CPU list %s\n", value);
+                return -1;
+            }
+            conf->has_cpus[s] = 1;
+            return 0;
+        }
+    }
+
+    if (strcmp(key, "QUEUE_NUMA") == 0) {
+        if (strcmp(value, "off") == 0)
+            conf->queue_numa = 0;
+        else if (strcmp(value, "on") == 0)
+            conf->queue_numa = 1;
+        else {
+            printf("Unknown queue placement %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    // Priority level of one category.
+    const char *priorities[N_CO_EDIT] = {"SPORT_PRIORITY", "NEWS_PRIORITY", "WEATHER_PRIORITY"};
+    for (int c = 0; c < N_CO_EDIT; c++) {
+        if (strcmp(key, priorities[c]) == 0) {
+            char *end;
+            long level = strtol(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || level < 0 || level >= PRIORITY_LEVELS) {
+                printf("Wrong priority %s\n", value);
+                return -1;
+            }
+            conf->priority[c] = (int) level;
+            conf->prioritized = 1;
+            return 0;
+        }
+    }
+
+    // Priority levels of producers, a list of ID:LEVEL pairs such as "1:0,3:1".
+    if (strcmp(key, "PRODUCER_PRIORITY") == 0) {
+        const char *p = value;
+        if (*p == '\0') {
+            printf("Wrong producer priority %s\n", value);
+            return -1;
+        }
+        while (*p != '\0') {
+            char *end;
+            long id = strtol(p, &end, 10);
+            long level = -1;
+            if (end != p && *end == ':') {
+                p = end + 1;
+                level = strtol(p, &end, 10);
+            }
+            int i = 0;
+            while (i < conf->n_pr && conf->prodArg[i].prod_id != id)
+                i++;
+            if (end == p || level < 0 || level >= PRIORITY_LEVELS || i == conf->n_pr
+                || (*end != ',' && *end != '\0')) {
+                printf("Wrong producer priority %s\n", value);
+                return -1;
+            }
+            conf->prodArg[i].priority = (int) level;
+            p = *end == ',' ? end + 1 : end;
+        }
+        conf->prioritized = 1;
+        return 0;
+    }
+
+    if (strcmp(key, "PRIORITY_AGE") == 0) {
+        conf->priority_age = atoi(value);
+        if (conf->priority_age < 1) {
+            printf("Wrong priority age %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (strcmp(key, "TELEMETRY") == 0) {
+        if (strlen(value) >= MAX_OPTION) {
+            printf("Wrong telemetry target %s\n", value);
+            return -1;
+        }
+        strcpy(conf->telemetry, value);
+        return 0;
+    }
+
+    if (strcmp(key, "SEED") == 0) {
+        char *end;
+        conf->seed = strtoull(value, &end, 0);
+        if (*value == '\0' || *end != '\0') {
+            printf("Wrong seed %s\n", value);
+            return -1;
+        }
+        return 0;
+    }
+
+    printf("Unknown option %s\n", key);
+    return -1;
+}
+
+
+int conf_args(Conf *conf, int argc, char const *argv[]) {
+    for (int i = 0; i < argc; i++) {
+        char key[MAX_OPTION];
+        const char *eq = strchr(argv[i], '=');
+        if (eq == NULL || eq - argv[i] >= MAX_OPTION) {
+            printf("Wrong argument %s\n", argv[i]);
+            return -1;
+        }
+        memcpy(key, argv[i], eq - argv[i]);
+        key[eq - argv[i]] = '\0';
+        if (conf_option(conf, key, eq + 1) != 0)
+            return -1;
+    }
+    return 0;
+}
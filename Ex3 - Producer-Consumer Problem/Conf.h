@@ -0,0 +1,167 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_CONF_H
+#define EX3_CONF_H
+
+#include "Channel.h"
+#include "Affinity.h"
+#include <stdint.h>
+
+#define MAX_OPTION 64
+#define DEFAULT_BATCH 32
+#define DEFAULT_FLUSH_MS 100
+#define DEFAULT_EDIT_MS 100
+#define DEFAULT_PRIORITY_AGE 4
+
+/*
+ * EDIT_MODE - How the stories reach the co-editors.
+ *  - EDIT_CATEGORY: The editors of a category share its editor queue.
+ *  - EDIT_STEAL: Every category has a lane, an editor whose lane runs dry takes over a free lane of another category (Steal_Pool).
+ */
+enum EDIT_MODE {EDIT_CATEGORY, EDIT_STEAL};
+
+
+/*
+ * EDITING - How a co-editor spends the editing time of a story.
+ *  - EDITING_SLEEP: The editor sleeps for the edit latency after every story, one story at a time.
+ *  - EDITING_TIMER: The editor keeps taking stories and releases each one when its latency has passed (Edit_Timer).
+ */
+enum EDITING {EDITING_SLEEP, EDITING_TIMER};
+
+
+/*
+ * RUNTIME - How the producers, dispatchers, co-editors and the screen manager run.
+ *  - RUNTIME_THREADS: One thread each.
+ *  - RUNTIME_COROUTINES: Cooperative coroutines on the main thread (Coro.h).
+ */
+enum RUNTIME {RUNTIME_THREADS, RUNTIME_COROUTINES};
+
+
+/*
+ * AFFINITY - Where the threads of the stages run, a stage with its own CPU list always runs there.
+ *  - AFFINITY_OFF: The other stages are left to the scheduler.
+ *  - AFFINITY_AUTO: The other stages are placed by affinity_auto.
+ */
+enum AFFINITY {AFFINITY_OFF, AFFINITY_AUTO};
+
+
+/*
+ * Prod_Conf - Structure for Producer Configuration
+ *
+ * This structure is used to store configuration information for a producer.
+ * It contains the producer's ID 'prod_id', the number of news to produce 'n_news',
+ * and the queue size 'q_size' for the bounded queue where news is placed.
+ * 'priority' is the priority level of the producer (PRODUCER_PRIORITY), the lowest one by default.
+ */
+typedef struct {
+    int prod_id;
+    int n_news;
+    int q_size;
+    int priority;
+} Prod_Conf;
+
+
+/*
+ * Conf - Overall Configuration Structure
+ *
+ * This structure is used to store the overall configuration for the program.
+ * It contains an array of producer configurations 'prodArg', the number of producers 'n_pr',
+ * and the size of the shared memory queue 'sm_q_size'.
+ *
+ * Optional settings:
+ *  - prod_queue: QUEUE_KIND of the producer queues (PRODUCER_QUEUE).
+ *  - sm_queue: QUEUE_KIND of the shared queue of the co-editors (SHARED_QUEUE), never QUEUE_SPSC.
+ *  - edit_queue: QUEUE_KIND of the editor queues (EDITOR_QUEUE), QUEUE_UNBOUNDED or QUEUE_CHUNKED.
+ *  - editors: Number of co-editor threads of every category (EDITORS, or SPORT_EDITORS, NEWS_EDITORS, WEATHER_EDITORS).
+ *  - batch: Maximum number of news taken from a queue at once by the dispatcher and the screen manager (BATCH).
+ *  - edit_mode: EDIT_MODE of the co-editors (EDIT_MODE, "category" or "steal").
+ *  - editing: EDITING of the co-editors (EDITING, "sleep" or "timer").
+ *  - runtime: RUNTIME of the pipeline (RUNTIME, "threads" or "coroutines").
+ *  - edit_ms: Edit latency of every category in milliseconds (EDIT_MS, or SPORT_EDIT_MS, NEWS_EDIT_MS, WEATHER_EDIT_MS).
+ *  - flush_ms: Longest time a printed line waits in the screen manager's output buffer (FLUSH_MS).
+ *  - dispatchers: Number of dispatcher threads, each of them serves its own shard of the producers (DISPATCHERS).
+ *  - affinity: AFFINITY of the stages (AFFINITY, "off" or "auto").
+ *  - cpus, has_cpus: CPU list of a stage, if it has one (PRODUCER_CPUS, DISPATCHER_CPUS, EDITOR_CPUS, SCREEN_CPUS).
+ *  - queue_numa: Create the queues of a stage on the CPUs of their consumer, so their memory is placed
+ *    on its NUMA node by the first touch (QUEUE_NUMA, "off" or "on").
+ *  - priority: Priority level of every category (SPORT_PRIORITY, NEWS_PRIORITY, WEATHER_PRIORITY), the lowest one by default.
+ *  - priority_age: Turns a waiting level may be passed over by more urgent ones (PRIORITY_AGE).
+ *  - prioritized: A priority was set, the stages order the stories by priority.
+ *  - telemetry: Where the telemetry is written (TELEMETRY, "off", "stderr" or a file), see Telemetry.h.
+ *  - seed: Master seed of the producers' random generators (SEED), the current time by default.
+ */
+typedef struct{
+    Prod_Conf * prodArg;
+    int n_pr;
+    int sm_q_size;
+    int prod_queue;
+    int sm_queue;
+    int edit_queue;
+    int batch;
+    int editors[N_CO_EDIT];
+    int edit_mode;
+    int editing;
+    int runtime;
+    int edit_ms[N_CO_EDIT];
+    int flush_ms;
+    int dispatchers;
+    uint64_t seed;
+    char telemetry[MAX_OPTION];
+    int affinity;
+    Cpu_Set cpus[N_STAGES];
+    int has_cpus[N_STAGES];
+    int queue_numa;
+    int priority[N_CO_EDIT];
+    int priority_age;
+    int prioritized;
+}Conf;
+
+
+/*
+ * read_conf - Read configuration data from a file and create a Conf structure.
+ *
+ * The producers and the shared queue size may be followed by optional settings,
+ * one "KEY VALUE" pair per line.
+ *
+ * Parameters:
+ *  const char* path - Path to the configuration file.
+ *
+ * Return:
+ *  Conf* - Pointer to the Conf structure containing configuration data.
+ *          Exits on failure.
+ */
+Conf* read_conf(const char* path);
+
+
+/*
+ * conf_option - Apply one optional setting.
+ *
+ * Parameters:
+ *  Conf* conf - Configuration to update.
+ *  const char* key - Name of the setting.
+ *  const char* value - Value of the setting.
+ *
+ * Return:
+ *  0 on success, -1 if the key or the value is invalid.
+ */
+int conf_option(Conf *conf, const char *key, const char *value);
+
+
+/*
+ * conf_args - Apply "KEY=VALUE" settings given on the command line, they override conf.txt.
+ *
+ * Parameters:
+ *  Conf* conf - Configuration to update.
+ *  int argc - Number of arguments.
+ *  char const* argv[] - Arguments.
+ *
+ * Return:
+ *  0 on success, -1 if an argument is invalid.
+ */
+int conf_args(Conf *conf, int argc, char const *argv[]);
+
+
+#endif //EX3_CONF_H
@@ -8,13 +8,21 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include "News.h"
 #include "Queue_B.h"
-#include "Queue_U.h"
+#include "Channel.h"
+#include "Conf.h"
+#include "Steal_Pool.h"
+#include "Hand_Off.h"
+#include "Level_Queue.h"
+#include "Rng.h"
+#include "Writer.h"
+#include "Edit_Timer.h"
+#include "Coro.h"
+#include "Telemetry.h"
 
 
-#define N_CO_EDIT 3
-
 pthread_t *producers;
 pthread_t *dispatcher;
 pthread_t *co_editors;
@@ -27,9 +35,12 @@ pthread_t *screen_manager;
  * This structure is used to pass arguments to producer threads.
  */
 typedef struct {
-    Queue_B *queue; // Pointer to the bounded queue for news
+    Channel *queue; // Pointer to the producer queue for news
     int n_news;     // Number of news to produce
     int index;      // Producer index
+    uint64_t seed;  // Master seed, the producer draws its own stream of it
+    int priority;   // Priority level of the producer
+    const int *categories; // Priority level of every category
 } Producer_arg;
 
 
@@ -38,62 +49,61 @@ typedef struct {
  * Co_Editors_Arg - Structure for Co-Editors Thread Arguments
  *
  * This structure is used to pass arguments to co-editors threads.
- * It contains pointers to a bounded queue 'q_b' and an unbounded queue 'q_u'.
+ * It contains pointers to the shared multi-level queue 'q_b' and an editor queue 'q_u'.
+ * With EDIT_STEAL the editor takes its news from the work-stealing pool 'pool' as editor 'id' instead of 'q_u',
+ * and releases the lane of every story once it is in the shared queue.
+ * When the editors of a category share 'q_u', an editor waits for the turn of every story on 'hand_off'.
+ * 'edit_ms' is the edit latency of every category.
  */
 typedef struct {
-    Queue_U *q_u;
-    Queue_B *q_b;
+    Channel *q_u;
+    Level_Queue *q_b;
+    Steal_Pool *pool;
+    Hand_Off *hand_off;
+    int id;
+    const int *edit_ms;
 } Co_Editors_Arg;
 
 /*
  * Dispatcher_Arg - Structure for Dispatcher Thread Arguments
  *
  * This structure is used to pass arguments to the dispatcher thread.
- * It contains arrays of pointers to bounded queues 'q_b', unbounded queues 'q_edit',
- * and the number of producers 'num_prod'.
+ * It contains arrays of pointers to producer queues 'q_b', editor queues 'q_edit',
+ * the number of producers 'num_prod', the readiness set 'ready' the producer queues mark,
+ * the maximum number of news articles 'batch' taken from a queue at once,
+ * and the number of editors of every category 'editors', each of them gets a "DONE" at the end.
+ * With EDIT_STEAL the news go to the work-stealing pool 'pool' instead of 'q_edit'.
+ * Every dispatcher owns a shard of the producer queues, 'running' counts the dispatchers that have not finished yet.
+ * 'levels' is the priority level of every producer queue of the shard, a level with news waits at most
+ * 'age' rounds while more urgent levels are served.
  */
 typedef struct {
-    Queue_B **q_b;
-    Queue_U **q_edit;
+    Channel **q_b;
+    Channel **q_edit;
     int num_prod;
+    Ready_Set *ready;
+    int batch;
+    int *editors;
+    Steal_Pool *pool;
+    atomic_int *running;
+    const int *levels;
+    int age;
 } Dispatcher_Arg;
 
 
-enum CO_EDITORS {
-    DONE = -1,
-    SPORT,
-    NEWS,
-    WEATHER
-};
-
-
 /*
- * Prod_Conf - Structure for Producer Configuration
+ * Screen_Arg - Structure for Screen Manager Thread Arguments
  *
- * This structure is used to store configuration information for a producer.
- * It contains the producer's ID 'prod_id', the number of news to produce 'n_news',
- * and the queue size 'q_size' for the bounded queue where news is placed.
+ * It contains the shared multi-level queue 'queue', the maximum number of news articles 'batch' taken from it at once,
+ * the number of editors 'n_editors', the screen manager waits for a "DONE" from each of them on every level,
+ * and the longest time 'flush_ms' a printed line waits in the output buffer while news keep coming.
  */
 typedef struct {
-    int prod_id;
-    int n_news;
-    int q_size;
-} Prod_Conf;
-
-
-/*
- * Conf - Overall Configuration Structure
- *
- * This structure is used to store the overall configuration for the program.
- * It contains an array of producer configurations 'prodArg', the number of producers 'n_pr',
- * and the size of the shared memory queue 'sm_q_size'.
- */
-typedef struct{
-    Prod_Conf * prodArg;
-    int n_pr;
-    int sm_q_size;
-}Conf;
-
+    Level_Queue *queue;
+    int batch;
+    int n_editors;
+    int flush_ms;
+} Screen_Arg;
 
 
 /*
@@ -105,6 +115,9 @@ typedef struct{
  * The produce function generates news articles based on random categories (SPORT, NEWS, or WEATHER)
  * and enqueues them into the given bounded queue. It continues producing until the specified
  * number of news articles (n_news) is reached.
+ * The categories come from the producer's own generator, seeded from the master seed and the
+ * producer index, so a seed gives the same stories on every run.
+ * Every story gets the more urgent of the priority levels of the producer and of its category.
  * 
  * Once all news articles are produced, a special "DONE" news article is enqueued to signal
  * the end of production.
@@ -116,40 +129,47 @@ void *produce(void *arg) {
 
     // Extract arguments
     Producer_arg *arguments = (Producer_arg *) arg;
-    Queue_B *queue = arguments->queue;
+    Channel *queue = arguments->queue;
     int n = arguments->n_news;
     int index = arguments->index;
+    Rng rng;
+    rng_seed(&rng, arguments->seed, index);
+    telemetry_thread(STAGE_PRODUCER);
 
 
     int randN;
     int sport = 0, news_counter = 0, weather = 0;
-    News *news;
+    Item news = {0};
 
     // Produce news articles with random category.
     for (int i = 1; i <= n; i++) {
-        randN = rand() % 3;
+        randN = rng_below(&rng, N_CO_EDIT);
         switch (randN) {
             case SPORT:
-                news = create_new(index, sport++, SPORT);
+                news = make_item(index, sport++, SPORT);
                 break;
             case NEWS:
-                news = create_new(index, news_counter++, NEWS);
+                news = make_item(index, news_counter++, NEWS);
                 break;
             case WEATHER:
-                news = create_new(index, weather++, WEATHER);
+                news = make_item(index, weather++, WEATHER);
                 break;
             default:
                 break;
         }
 
         // Enqueue the generated news article
-        enqueue_b_mut(queue, news);
+        int level = arguments->categories[randN];
+        ITEM_NEWS(news)->priority = level < arguments->priority ? level : arguments->priority;
+        telemetry_stamp(ITEM_NEWS(news));
+        channel_put(queue, news);
+        telemetry_items(1);
 
     }
 
     // Enqueue a special "DONE" news article to signal the end of production
-    news = create_new(DONE, DONE, DONE);
-    enqueue_b_mut(queue, news);
+    news = make_item(DONE, DONE, DONE);
+    channel_put(queue, news);
 
     return NULL;
 }
@@ -158,11 +178,15 @@ void *produce(void *arg) {
 /*
  * consume - Function for consuming news articles from multiple bounded queues
  * and distributing them to corresponding editors.
- * The consume function continuously dequeues news articles from multiple bounded queues
- * (queueB) in a round-robin fashion. It checks the category of each news article and enqueues
+ * The consume function sleeps until some of the producer queues (queueB) have news and
+ * then dequeues one batch of news articles from every ready queue per round, so the queues are served fairly.
+ * Within a round the queues of the most urgent producers are served, a priority level passed over
+ * for 'age' rounds is served as well.
+ * It checks the category of each news article and enqueues
  * it into the appropriate editor queue (q_editors) based on the category (SPORT, NEWS, or WEATHER).
  * The function continues consuming news articles until it encounters the "DONE" news article
- * from all producer queues, at which point it terminates.
+ * from all producer queues of its shard, at which point it terminates.
+ * The last dispatcher to terminate sends the "DONE" news articles to the editors.
  *  
  * Parameters:
  *  void *arg - A pointer to the Dispatcher_Arg structure containing dispatcher arguments.
@@ -174,61 +198,156 @@ void *consume(void *arg) {
 
     // Extract arguments
     Dispatcher_Arg *d = (Dispatcher_Arg *) arg;
-    Queue_B **queueB = d->q_b;
-    Queue_U **q_editors = d->q_edit;
+    Channel **queueB = d->q_b;
+    Channel **q_editors = d->q_edit;
     int n = d->num_prod;
 
+    int batch = d->batch;
+    telemetry_thread(STAGE_DISPATCHER);
+
     int is_consume = 1;
-    int r = 0;
     int done_count = 0;
 
-    News *news;
-    while (is_consume) {
-        // Dequeue a news article from a bounded queue in round-robin fashion
-        news = try_dequeue_b_mut(queueB[r]);
-        r = (r + 1) % n;
-        if (!news)
-            continue;
-        Node *node = create_node_by_new(news);
+    // Queues the dispatcher knows to have news, one bit per producer.
+    int words = (n + READY_BITS - 1) / READY_BITS;
+    unsigned long *pending = (unsigned long *) calloc(words, sizeof(unsigned long));
+    if (pending == NULL)
+        exit(1);
+    int any = 0;
 
-        // Enqueue the news article into the corresponding editor queue based on category
-        switch (news->category) {
-            case SPORT:
-                enqueue_u_mut(*(q_editors + SPORT), node);
-                break;
-            case NEWS:
-                enqueue_u_mut(*(q_editors + NEWS), node);
-                break;
-            case WEATHER:
-                enqueue_u_mut(*(q_editors + WEATHER), node);
-                break;
-            case DONE:
-                ++done_count;
-                free(news);
-                free(node);
-                if (done_count == n) {
-                    is_consume = 0;
+    // Producer queues of every priority level, one bit per producer, and the rounds each level was passed over
+    unsigned long *level_bits = (unsigned long *) calloc(PRIORITY_LEVELS * words, sizeof(unsigned long));
+    if (level_bits == NULL)
+        exit(1);
+    for (int i = 0; i < n; i++)
+        level_bits[d->levels[i] * words + i / READY_BITS] |= 1UL << (i % READY_BITS);
+    int passed[PRIORITY_LEVELS] = {0};
+
+    // A batch taken from one producer queue, and its news sorted by editor queue.
+    Item *news = (Item *) malloc(batch * sizeof(Item));
+    Item *routed = (Item *) malloc(N_CO_EDIT * batch * sizeof(Item));
+    if (news == NULL || routed == NULL)
+        exit(1);
+
+    while (is_consume) {
+        // Sleep until a producer queue has news, then take one batch from every ready queue per round
+        ready_collect(d->ready, pending, !any);
+        any = 0;
+
+        // The most urgent level with news is served, a less urgent one only after waiting 'age' rounds
+        int served = 0;
+        for (int l = 0; l < PRIORITY_LEVELS; l++) {
+            unsigned long *mask = level_bits + l * words;
+            int waiting = 0;
+            for (int w = 0; w < words; w++)
+                waiting |= (pending[w] & mask[w]) != 0;
+            if (!waiting) {
+                passed[l] = 0;
+                continue;
+            }
+            if (served && passed[l] < d->age) {
+                passed[l]++;
+                continue;
+            }
+            passed[l] = 0;
+
+            for (int w = 0; w < words; w++) {
+                unsigned long bits = pending[w] & mask[w];
+                while (bits) {
+                    int r = w * READY_BITS + __builtin_ctzl(bits);
+                    bits &= bits - 1;
+
+                    // An empty queue stays quiet until its producer marks it again
+                    int count = channel_try_get_many(queueB[r], news, batch);
+                    if (count == 0) {
+                        pending[w] &= ~(1UL << (r % READY_BITS));
+                        continue;
+                    }
+                    served = 1;
+
+                    // Sort the news articles by category, they keep their order within a category
+                    int n_routed[N_CO_EDIT] = {0};
+                    for (int i = 0; i < count; i++) {
+                        int cat = ITEM_NEWS(news[i])->category;
+                        switch (cat) {
+                            case SPORT:
+                            case NEWS:
+                            case WEATHER:
+                                routed[cat * batch + n_routed[cat]++] = news[i];
+                                break;
+                            case DONE:
+                                ++done_count;
+                                free_item(news[i]);
+                                if (done_count == n) {
+                                    is_consume = 0;
+                                }
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+
+                    // Enqueue each category into its editor queue at once, in recycled nodes
+                    telemetry_items(n_routed[SPORT] + n_routed[NEWS] + n_routed[WEATHER]);
+                    for (int c = 0; c < N_CO_EDIT; c++) {
+                        if (d->pool != NULL)
+                            steal_pool_put_many(d->pool, c, routed + c * batch, n_routed[c]);
+                        else
+                            channel_put_many(*(q_editors + c), routed + c * batch, n_routed[c]);
+                    }
                 }
-                break;
-            default:
-                break;
+            }
         }
+        for (int w = 0; w < words; w++)
+            any |= pending[w] != 0;
+    }
+    free(pending);
+    free(level_bits);
+    free(news);
+    free(routed);
+
+    // Other dispatchers may still route news, the last one to finish signals the editors
+    if (atomic_fetch_sub(d->running, 1) != 1)
+        return NULL;
+
+    // Enqueue a "DONE" news article for every editor of each editor queue to signal completion
+    if (d->pool != NULL) {
+        steal_pool_done(d->pool);
+        return NULL;
+    }
+    for (int c = 0; c < N_CO_EDIT; c++) {
+        for (int i = 0; i < d->editors[c]; i++)
+            channel_put(*(q_editors + c), make_item(DONE, DONE, DONE));
     }
-
-    // Enqueue "DONE" news articles into each editor queue to signal completion
-    enqueue_u_mut(*(q_editors + SPORT), create_node_by_value(DONE, DONE, DONE));
-    enqueue_u_mut(*(q_editors + NEWS), create_node_by_value(DONE, DONE, DONE));
-    enqueue_u_mut(*(q_editors + WEATHER), create_node_by_value(DONE, DONE, DONE));
 
     return NULL;
 }
 
 
+/*
+ * put_story - Put an edited story into the shared queue. A story of the pool releases its lane after it is there,
+ * so the next story of the category cannot overtake it. With editors that share a queue the story waits
+ * for its turn, after the story before it of the same producer and category.
+ */
+static void put_story(Co_Editors_Arg *qs, Item news) {
+    int producer = ITEM_NEWS(news)->producer;
+    int category = ITEM_NEWS(news)->category;
+    if (qs->hand_off != NULL)
+        hand_off_wait(qs->hand_off, producer, category, ITEM_NEWS(news)->index);
+    level_queue_put(qs->q_b, news);
+    if (qs->hand_off != NULL)
+        hand_off_next(qs->hand_off, producer, category);
+    if (qs->pool != NULL)
+        steal_pool_release(qs->pool, qs->id, category);
+}
+
+
 /*
  * co_edit - Function for cooperative editing of news articles.
- * The co_edit function dequeues news articles from a Queue_U (editor queue), performs
- * cooperative editing by enqueuing the news article into a Queue_B (bounded queue),
- * and introduces a delay for non-"DONE" news articles to simulate editing time.
+ * The co_edit function dequeues news articles from its editor queue, performs
+ * cooperative editing by enqueuing the news article into the shared queue,
+ * and introduces a delay for non-"DONE" news articles to simulate editing time
+ * (the edit latency of the article's category).
  * 
  * The function continues co-editing news articles until it encounters the "DONE" news article,
  * at which point it terminates.
@@ -242,21 +361,31 @@ void *consume(void *arg) {
 void *co_edit(void *arg) {
     // Extract arguments
     Co_Editors_Arg *qs = (Co_Editors_Arg *) arg;
-    Queue_B *queueB = qs->q_b;
-    Queue_U *queueU = qs->q_u;
+    Level_Queue *queueB = qs->q_b;
+    Channel *queueU = qs->q_u;
+    telemetry_thread(STAGE_EDITOR);
 
     int is_consume = 1;
-    News *news;
+    Item news;
     while (is_consume) {
-        // Dequeue a news article from the editor queue (Queue_U)
-        news = dequeue_u_mut(queueU);
+        // Dequeue a news article from the editor queue, or take one from the pool
+        if (qs->pool != NULL)
+            news = steal_pool_take(qs->pool, qs->id);
+        else
+            news = channel_get(queueU);
 
-        // Enqueue the news article into the bounded queue (Queue_B)
-        enqueue_b_mut(queueB, news);
+        // Enqueue the news article into the shared queue, a "DONE" goes on every level of it
+        int category = ITEM_NEWS(news)->category;
+        if (category == DONE)
+            level_queue_done(queueB, news);
+        else
+            put_story(qs, news);
 
         // Introduce a delay (simulating editing time) for non-"DONE" news articles
-        if (news->category != DONE)
-            usleep(100000);
+        if (category != DONE) {
+            telemetry_items(1);
+            coro_usleep(qs->edit_ms[category] * 1000);
+        }
         else
             is_consume = 0;
 
@@ -266,10 +395,83 @@ void *co_edit(void *arg) {
 }
 
 
+/*
+ * take_story - Take the next story of an editor from its editor queue or the pool.
+ * Waits until 'deadline' at the latest, or without a limit if it is NULL. Returns -1 if nothing came.
+ */
+static int take_story(Co_Editors_Arg *qs, Item *out, const struct timespec *deadline) {
+    if (qs->pool != NULL)
+        return steal_pool_take_until(qs->pool, qs->id, out, deadline);
+    return channel_get_until(qs->q_u, out, deadline);
+}
+
+
+/*
+ * co_edit_timer - Co-editor with EDITING_TIMER: editing is a scheduled completion instead of a sleep.
+ *
+ * The editor takes every story that is ready and starts its edit latency on an Edit_Timer.
+ * A story goes to the shared queue when its latency has passed. While stories are in editing, the editor
+ * waits for new ones only until the next one finishes, so one editor has many stories in editing at once.
+ * After the "DONE" the editor takes nothing more, waits for the stories still in editing and puts the
+ * "DONE" after them.
+ *
+ * Parameters:
+ *  void *arg - A pointer to the Co_Editors_Arg structure containing co-editing arguments.
+ *
+ * Return:
+ *  None
+ */
+void *co_edit_timer(void *arg) {
+    Co_Editors_Arg *qs = (Co_Editors_Arg *) arg;
+    Edit_Timer *timer = create_edit_timer(qs->edit_ms);
+    telemetry_thread(STAGE_EDITOR);
+
+    Item news, done = {0};
+    int is_done = 0;
+    struct timespec now, next;
+    while (1) {
+        // Release the stories whose editing is over
+        clock_gettime(CLOCK_REALTIME, &now);
+        while (edit_timer_expired(timer, &now, &news) == 0)
+            put_story(qs, news);
+
+        int editing = edit_timer_next(timer, &next) == 0;
+        if (is_done) {
+            if (!editing)
+                break;
+            coro_sleep_until(&next);
+            continue;
+        }
+
+        // Wait for a story until the next one finishes
+        if (take_story(qs, &news, editing ? &next : NULL) != 0)
+            continue;
+
+        // Start it and every other story that is already there
+        clock_gettime(CLOCK_REALTIME, &now);
+        do {
+            if (ITEM_NEWS(news)->category == DONE) {
+                done = news;
+                is_done = 1;
+                break;
+            }
+            edit_timer_add(timer, news, &now);
+            telemetry_items(1);
+        } while (take_story(qs, &news, &now) == 0);
+    }
+
+    level_queue_done(qs->q_b, done);
+    delete_edit_timer(timer);
+    return NULL;
+}
+
+
 /*
  * print_to_screen - Print a message to the screen based on news category, producer ID, and index.
+ * The line is formatted into the screen manager's output buffer, not written at once.
  * 
  * Parameters:
+ *  Writer *out - Output buffer of the screen
  *  int prod_id - Producer ID
  *  int cat - News category (SPORT, NEWS, or WEATHER)
  *  int index - News index
@@ -277,20 +479,16 @@ void *co_edit(void *arg) {
  * Return:
  *  None
  */
-void print_to_screen(int prod_id, int cat, int index){
-    switch (cat) {
-        case SPORT:
-            printf("Producer %d SPORTS %d\n", prod_id, index);
-            break;
-        case NEWS:
-            printf("Producer %d NEWS %d\n", prod_id, index);
-            break;
-        case WEATHER:
-            printf("Producer %d WEATHER %d\n", prod_id, index);
-            break;
-        default:
-            break;
-    }
+void print_to_screen(Writer *out, int prod_id, int cat, int index){
+    static const char *names[N_CO_EDIT] = {" SPORTS ", " NEWS ", " WEATHER "};
+    static const int lengths[N_CO_EDIT] = {8, 6, 9};
+    if (cat < 0 || cat >= N_CO_EDIT)
+        return;
+    writer_str(out, "Producer ", 9);
+    writer_int(out, prod_id);
+    writer_str(out, names[cat], lengths[cat]);
+    writer_int(out, index);
+    writer_end_line(out);
 }
 
 
@@ -299,123 +497,109 @@ void print_to_screen(int prod_id, int cat, int index){
  * screen_manage - Manage the printing of news messages to the screen.
  * 
  * Parameters:
- *  Queue_B *queueB - Bounded queue of news messages
+ *  void *arg - A pointer to the Screen_Arg structure containing the shared queue and the batch size.
  * 
- * This function dequeues news messages from the given bounded queue and prints them to the screen.
+ * This function dequeues news messages from the shared queue, a batch at a time and the most urgent level first,
+ * and prints them to the screen.
  * It keeps track of the number of "DONE" messages received to determine when to exit.
+ * The output is buffered and written when the buffer is full, every 'flush_ms' milliseconds,
+ * before waiting on an empty queue, and at the end.
  * 
  * Return:
  *  None
  */
 void *screen_manage(void *arg) {
     // Extract arguments
-    Queue_B *queueB = (Queue_B *) arg;
+    Screen_Arg *sa = (Screen_Arg *) arg;
+    Level_Queue *queueB = sa->queue;
 
     int is_consume = 1;
-    int done_number = 0;   // Count till 3
-    News *news;
+    int done_number = 0;   // Count till the number of editors on every level
+    Item *news = (Item *) malloc(sa->batch * sizeof(Item));
     int i = 0;
 
+    if (news == NULL)
+        exit(1);
+    Writer *out = create_writer(STDOUT_FILENO, sa->flush_ms);
+    telemetry_thread(STAGE_SCREEN);
 
     while (is_consume) {
 
-        // Dequeue from screen manager queue
-        news = dequeue_b_mut(queueB);
+        // Dequeue from screen manager queue everything that is ready, write the output out before sleeping
+        int count = level_queue_get_many(queueB, news, sa->batch, 0);
+        if (count == 0) {
+            writer_flush(out);
+            count = level_queue_get_many(queueB, news, sa->batch, 1);
+        }
 
-        // If it's not DONE message, print on the screen.
-        if (news->category == DONE)
-            done_number++;
-        else {
-            print_to_screen(news->producer, news->category, news->index);
-            ++i;
+        for (int k = 0; k < count; k++) {
+            // If it's not DONE message, print on the screen.
+            News *n = ITEM_NEWS(news[k]);
+            if (n->category == DONE)
+                done_number++;
+            else {
+                print_to_screen(out, n->producer, n->category, n->index);
+                telemetry_delivered(n);
+                telemetry_items(1);
+                ++i;
+            }
+            free_item(news[k]);
         }
-        free(news);
 
         // Every editor has finished, screen manager finishes too.
-        if (done_number == 3) {
-            printf("DONE\n");
+        if (done_number == sa->n_editors * queueB->n) {
+            writer_str(out, "DONE", 4);
+            writer_end_line(out);
             is_consume = 0;
         }
+        else
+            writer_tick(out);
 
     }
+    delete_writer(out);
+    free(news);
 
     return NULL;
 }
 
 
 /*
- * read_conf - Read configuration data from a file and create a Conf structure.
- * 
+ * spawn - Start a thread, or a coroutine with RUNTIME_COROUTINES. Exits on failure.
+ *
  * Parameters:
- *  const char* path - Path to the configuration file.
- * 
- * Return:
- *  Conf* - Pointer to the Conf structure containing configuration data.
- *          Returns NULL on failure.
+ *  pthread_t *t - Receives the thread, not used for a coroutine.
+ *  void *(*fn)(void *) - Function of the thread.
+ *  void *arg - Argument of the function.
+ *  int runtime - RUNTIME of the pipeline.
+ *  const Cpu_Set *cpus - CPUs the thread runs on, NULL to leave it to the scheduler. Not used for a coroutine.
  */
-Conf* read_conf(const char* path) {
-    FILE* file = fopen(path, "r");
-    if (file == NULL) {
-        exit(1);
-    }
-
-    Prod_Conf* arguments = NULL;
-    int objectCount = 0;
-    int maxObjects = 0;
-
-    Prod_Conf temp_arg;
-
-    // Read regular arguments
-    while (fscanf(file, "%d", &temp_arg.prod_id) == 1
-           && fscanf(file, "%d", &temp_arg.n_news) == 1
-           && fscanf(file, "%d", &temp_arg.q_size) == 1){
-
-
-        if (objectCount >= maxObjects) {
-            maxObjects += 5;
-            Prod_Conf* newObjects = realloc(arguments, maxObjects * sizeof(Prod_Conf));
-            if (newObjects == NULL) {
-                exit(1);
-            }
-            arguments = newObjects;
-        }
-
-
-        arguments[objectCount] = temp_arg;
-        objectCount++;
+static void spawn(pthread_t *t, void *(*fn)(void *), void *arg, int runtime, const Cpu_Set *cpus) {
+    if (runtime == RUNTIME_COROUTINES) {
+        coro_spawn(fn, arg);
+        return;
     }
-
-    if (!feof(file) || ferror(file))
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (cpus != NULL)
+        affinity_attr(&attr, cpus);
+    if (pthread_create(t, &attr, fn, arg) != 0)
         exit(1);
-
-    fclose(file);
-
-
-
-    Conf* conf = (Conf*) malloc(sizeof (Conf));
-    conf->prodArg = arguments;
-    conf->n_pr = objectCount;
-    conf->sm_q_size = temp_arg.prod_id;
-
-    return conf;
+    pthread_attr_destroy(&attr);
 }
 
 
-
-
 int main(int argc, char const *argv[]) {
 
-    // Seed the random number generator with the current time
-    srand(time(NULL));
-
     // Check for the correct number of command line arguments
-    if (argc != 2){
+    if (argc < 2){
         printf("Wrong number of arguments!");
         exit(1);
     }
 
-    // Read the configuration data from the specified file
+    // Read the configuration data from the specified file, KEY=VALUE arguments override it
     Conf* conf = read_conf(argv[1]);
+    if (conf_args(conf, argc - 2, argv + 2) != 0)
+        exit(1);
 
     // Get the number of producers
     int n_prod = conf->n_pr;
@@ -428,21 +612,87 @@ int main(int argc, char const *argv[]) {
         }
     }
 
-    // Create an array of Queue_B pointers for producer queues
-    Queue_B**  queue_prods = (Queue_B**)malloc(n_prod* sizeof (Queue_B*));
-    if (queue_prods == NULL)
+    // CPUs of every stage: its own list, else the automatic placement, else none
+    Cpu_Set auto_cpus[N_STAGES];
+    int has_auto = conf->affinity == AFFINITY_AUTO && affinity_auto(auto_cpus) == 0;
+    const Cpu_Set *cpus[N_STAGES];
+    for (int s = 0; s < N_STAGES; s++)
+        cpus[s] = conf->has_cpus[s] ? &conf->cpus[s] : has_auto ? &auto_cpus[s] : NULL;
+
+    // With QUEUE_NUMA, the queues of a stage are created on the CPUs of the stage that takes from them
+    const Cpu_Set *place[N_STAGES] = {NULL};
+    if (conf->queue_numa) {
+        place[STAGE_DISPATCHER] = cpus[STAGE_DISPATCHER];
+        place[STAGE_EDITOR] = cpus[STAGE_EDITOR];
+        place[STAGE_SCREEN] = cpus[STAGE_SCREEN];
+    }
+    Cpu_Set home;
+
+    // Create an array of Channel pointers for producer queues
+    Channel**  queue_prods = (Channel**)malloc(n_prod* sizeof (Channel*));
+    int *prod_levels = (int *) malloc(n_prod * sizeof(int));
+    if (queue_prods == NULL || prod_levels == NULL)
         exit(1);
 
-    // Create a shared memory queue
-    Queue_B *queue_sm = create_queue_b(conf->sm_q_size);
-    // Create queues for co-editors
-    Queue_U *queues_editors[N_CO_EDIT] = {create_queue_u(), create_queue_u(), create_queue_u()};
+    // Every dispatcher owns a contiguous shard of the producers, with its own readiness set
+    int n_disp = conf->dispatchers < n_prod ? conf->dispatchers : n_prod;
+    if (n_disp < 1)
+        n_disp = 1;
+    Dispatcher_Arg *dis = (Dispatcher_Arg *) malloc(n_disp * sizeof(Dispatcher_Arg));
+    if (dis == NULL)
+        exit(1);
+    for (int k = 0; k < n_disp; k++) {
+        int start = k * n_prod / n_disp;
+        dis[k].num_prod = (k + 1) * n_prod / n_disp - start;
+        dis[k].q_b = queue_prods + start;
+        dis[k].levels = prod_levels + start;
+        dis[k].ready = create_ready_set(dis[k].num_prod);
+    }
 
-    // Initialize Co-Editors arguments
-    Co_Editors_Arg coEditorsArg[N_CO_EDIT];
-    for (int i = 0; i < N_CO_EDIT; i++) {
-        coEditorsArg[i].q_b = queue_sm;
-        coEditorsArg[i].q_u = queues_editors[i];
+    // Create a shared memory queue, with a level of every priority once a priority is set
+    affinity_enter(place[STAGE_SCREEN], &home);
+    Level_Queue *queue_sm = create_level_queue(conf->sm_queue, conf->sm_q_size,
+                                               conf->prioritized ? PRIORITY_LEVELS : 1, conf->priority_age);
+    affinity_leave(place[STAGE_SCREEN], &home);
+    // Create queues for co-editors, or the work-stealing pool
+    Channel *queues_editors[N_CO_EDIT] = {NULL};
+    Steal_Pool *pool = NULL;
+    affinity_enter(place[STAGE_EDITOR], &home);
+    if (conf->edit_mode == EDIT_STEAL)
+        pool = create_steal_pool(conf->editors, conf->prioritized ? conf->priority_age : 0);
+    else {
+        for (int i = 0; i < N_CO_EDIT; i++)
+            queues_editors[i] = create_channel(conf->edit_queue, 0);
+    }
+    affinity_leave(place[STAGE_EDITOR], &home);
+
+    // Initialize Co-Editors arguments, the editors of a category share its queue or its lane of the pool
+    int n_editors = 0;
+    for (int c = 0; c < N_CO_EDIT; c++)
+        n_editors += conf->editors[c];
+
+    // Editors that share a queue take turns, for every producer index
+    Hand_Off *hand_off = NULL;
+    if (pool == NULL && n_editors > N_CO_EDIT) {
+        int n_index = 0;
+        for (int i = 0; i < n_prod; i++) {
+            if (conf->prodArg[i].prod_id > n_index)
+                n_index = conf->prodArg[i].prod_id;
+        }
+        hand_off = create_hand_off(n_index);
+    }
+    Co_Editors_Arg *coEditorsArg = (Co_Editors_Arg *) malloc(n_editors * sizeof(Co_Editors_Arg));
+    if (coEditorsArg == NULL)
+        exit(1);
+    for (int c = 0, i = 0; c < N_CO_EDIT; c++) {
+        for (int k = 0; k < conf->editors[c]; k++, i++) {
+            coEditorsArg[i].q_b = queue_sm;
+            coEditorsArg[i].q_u = queues_editors[c];
+            coEditorsArg[i].pool = pool;
+            coEditorsArg[i].hand_off = conf->editors[c] > 1 ? hand_off : NULL;
+            coEditorsArg[i].id = i;
+            coEditorsArg[i].edit_ms = conf->edit_ms;
+        }
     }
 
 
@@ -455,13 +705,25 @@ int main(int argc, char const *argv[]) {
 
 
     // Create producer queues and fill Producer_arg structures
+    affinity_enter(place[STAGE_DISPATCHER], &home);
     for (int i = 0; i < n_prod; i++) {
         p = &conf->prodArg[i];
-        Queue_B *q = create_queue_b(p->q_size);
+        Channel *q = create_channel(conf->prod_queue, p->q_size);
         pr_arg[i].queue = q;
         pr_arg[i].index = p->prod_id - 1;
         pr_arg[i].n_news = p->n_news;
+        pr_arg[i].seed = conf->seed;
+        pr_arg[i].priority = p->priority;
+        pr_arg[i].categories = conf->priority;
         queue_prods[i] = q;
+        prod_levels[i] = p->priority;
+    }
+    affinity_leave(place[STAGE_DISPATCHER], &home);
+
+    // A producer queue marks its bit in the readiness set of its dispatcher
+    for (int k = 0; k < n_disp; k++) {
+        for (int j = 0; j < dis[k].num_prod; j++)
+            channel_watch(dis[k].q_b[j], dis[k].ready, j);
     }
 
     // Allocate space for threads.
@@ -469,11 +731,11 @@ int main(int argc, char const *argv[]) {
     if (producers == NULL)
         exit(1);
 
-    dispatcher = (pthread_t *) malloc(sizeof(pthread_t));
+    dispatcher = (pthread_t *) malloc(n_disp * sizeof(pthread_t));
     if (dispatcher == NULL)
         exit(1);
 
-    co_editors = (pthread_t *) malloc(N_CO_EDIT * sizeof(pthread_t));
+    co_editors = (pthread_t *) malloc(n_editors * sizeof(pthread_t));
     if (co_editors == NULL)
         exit(1);
 
@@ -482,70 +744,100 @@ int main(int argc, char const *argv[]) {
         exit(1);
 
 
-    // Create Dispatcher_Arg structure for the dispatcher thread
-    Dispatcher_Arg dis;
-    dis.q_b = queue_prods;
-    dis.q_edit = queues_editors;
-    dis.num_prod = n_prod;
-
-    int err;
-    // Create producer threads
-    for (int i = 0; i < n_prod; i++) {
-        err = pthread_create(producers + i, NULL, &produce, (void *) &pr_arg[i]);
-        if (err != 0)
-            exit(1);
+    // Fill the Dispatcher_Arg structures of the dispatcher threads
+    atomic_int running = n_disp;
+    for (int k = 0; k < n_disp; k++) {
+        dis[k].q_edit = queues_editors;
+        dis[k].batch = conf->batch;
+        dis[k].editors = conf->editors;
+        dis[k].pool = pool;
+        dis[k].running = &running;
+        dis[k].age = conf->priority_age;
     }
 
-    // Create the dispatcher thread
-    err = pthread_create(dispatcher, NULL, &consume, (void *) &dis);
-    if (err != 0)
+    // Telemetry of the queues, started before the threads so they inherit its signal mask
+    telemetry_queues("producer", queue_prods, n_prod);
+    if (pool == NULL)
+        telemetry_queues("editor", queues_editors, N_CO_EDIT);
+    telemetry_queues("shared", queue_sm->levels, queue_sm->n);
+    if (telemetry_start(conf->telemetry) != 0)
         exit(1);
 
+    // Create producer threads
+    int runtime = conf->runtime;
+    for (int i = 0; i < n_prod; i++)
+        spawn(producers + i, &produce, (void *) &pr_arg[i], runtime, cpus[STAGE_PRODUCER]);
+
+    // Create the dispatcher threads
+    for (int k = 0; k < n_disp; k++)
+        spawn(dispatcher + k, &consume, (void *) &dis[k], runtime, cpus[STAGE_DISPATCHER]);
+
     
     // Create co-editor threads
-    for (int i = 0; i < N_CO_EDIT; i++) {
-        err = pthread_create(co_editors + i, NULL, &co_edit, (void *) &coEditorsArg[i]);
-        if (err != 0)
-            exit(1);
-    }
+    for (int i = 0; i < n_editors; i++)
+        spawn(co_editors + i, conf->editing == EDITING_TIMER ? &co_edit_timer : &co_edit,
+              (void *) &coEditorsArg[i], runtime, cpus[STAGE_EDITOR]);
 
     // Create the screen manager thread
-    err =  pthread_create(screen_manager, NULL, &screen_manage, (void *) queue_sm);
-    if (err != 0)
-        exit(1);
-
+    Screen_Arg screen_arg;
+    screen_arg.queue = queue_sm;
+    screen_arg.batch = conf->batch;
+    screen_arg.n_editors = n_editors;
+    screen_arg.flush_ms = conf->flush_ms;
+    spawn(screen_manager, &screen_manage, (void *) &screen_arg, runtime, cpus[STAGE_SCREEN]);
+
+
+    // The coroutines run on this thread until all of them returned
+    if (runtime == RUNTIME_COROUTINES)
+        coro_run();
+    else {
+        // Wait for producer threads to finish
+        for (int i = 0; i < n_prod; i++){
+            pthread_join(*(producers + i), NULL);
+        }
 
-    // Wait for producer threads to finish
-    for (int i = 0; i < n_prod; i++){
-        pthread_join(*(producers + i), NULL);
-    }
+        // Wait for the dispatcher threads to finish
+        for (int k = 0; k < n_disp; k++) {
+            pthread_join(*(dispatcher + k), NULL);
+        }
 
-    // Wait for the dispatcher thread to finish
-    pthread_join(*dispatcher, NULL);
+        // Wait for co-editor threads to finish
+        for (int i = 0; i < n_editors; i++) {
+            pthread_join(*(co_editors + i), NULL);
+        }
 
-    // Wait for co-editor threads to finish
-    for (int i = 0; i < N_CO_EDIT; i++) {
-        pthread_join(*(co_editors + i), NULL);
+        // Wait for the screen manager thread to finish
+        pthread_join(*screen_manager, NULL);
     }
 
-    // Wait for the screen manager thread to finish
-    pthread_join(*screen_manager, NULL);
 
+    telemetry_stop();
 
     // Free allocated memory
     free(conf->prodArg);
     free(conf);
+    free(coEditorsArg);
     free(queue_prods);
+    free(prod_levels);
+    for (int k = 0; k < n_disp; k++) {
+        delete_ready_set(dis[k].ready);
+    }
+    free(dis);
 
-    free(queue_sm->news);
-    free(queue_sm);
+    delete_level_queue(queue_sm);
 
-    for (int i = 0; i < N_CO_EDIT; i++) {
-       delete_queue_u(queues_editors[i]);
+    if (hand_off != NULL)
+        delete_hand_off(hand_off);
+    if (pool != NULL)
+        delete_steal_pool(pool);
+    else {
+        for (int i = 0; i < N_CO_EDIT; i++) {
+           delete_channel(queues_editors[i]);
+        }
     }
 
     for( int i =0; i < n_prod; i++){
-        delete_queue_b(pr_arg[i].queue);
+        delete_channel(pr_arg[i].queue);
     }
     free(pr_arg);
 
@@ -553,6 +845,7 @@ int main(int argc, char const *argv[]) {
     free(dispatcher);
     free(co_editors);
     free(screen_manager);
+    delete_news_pool();
 
     return 0;
 }
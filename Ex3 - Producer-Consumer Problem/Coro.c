@@ -0,0 +1,315 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Coro.h"
+#include "Telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <ucontext.h>
+
+
+/*
+ * State of a coroutine.
+ *  - CORO_RUNNABLE: Runs on the next round
+ *  - CORO_WAITING: Runs after a signal, or at 'deadline' if 'timed'
+ *  - CORO_SLEEPING: Runs at 'deadline'
+ *  - CORO_FINISHED: Returned
+ */
+enum CORO_STATE {CORO_RUNNABLE, CORO_WAITING, CORO_SLEEPING, CORO_FINISHED};
+
+
+/*
+ * Struct: Coro
+ * Description: A coroutine. Allocated on its own, a ucontext_t must not move.
+ * 'local' is the slot returned by coro_local.
+ */
+typedef struct
+{
+    ucontext_t context;
+    void *(*fn)(void *);
+    void *arg;
+    void *local;
+    char *stack;
+    int state;
+    int timed;
+    struct timespec deadline;
+} Coro;
+
+
+static Coro **coros = NULL;
+static int n_coros = 0;
+static int max_coros = 0;
+static Coro *current = NULL;
+static ucontext_t scheduler;
+static int signalled = 0;
+
+
+/*
+ * time_before - Returns 1 if time a is earlier than time b.
+ */
+static int time_before(const struct timespec *a, const struct timespec *b)
+{
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+
+/*
+ * coro_main - First function of every coroutine, returns to the scheduler through uc_link.
+ */
+static void coro_main(void)
+{
+    current->fn(current->arg);
+    current->state = CORO_FINISHED;
+}
+
+
+/*
+ * coro_switch - Give the thread back to the scheduler, in the given state.
+ */
+static void coro_switch(int state)
+{
+    current->state = state;
+    swapcontext(&current->context, &scheduler);
+}
+
+
+int coro_active(void)
+{
+    return current != NULL;
+}
+
+
+void **coro_local(void)
+{
+    return current == NULL ? NULL : &current->local;
+}
+
+
+void coro_spawn(void *(*fn)(void *), void *arg)
+{
+    if (n_coros == max_coros)
+    {
+        max_coros = max_coros == 0 ? 16 : 2 * max_coros;
+        Coro **grown = (Coro **)realloc(coros, max_coros * sizeof(Coro *));
+        if (grown == NULL)
+        {
+            printf("Error! Memory allocating\n");
+            exit(1);
+        }
+        coros = grown;
+    }
+
+    Coro *c = (Coro *)malloc(sizeof(Coro));
+    char *stack = (char *)malloc(CORO_STACK);
+    if (c == NULL || stack == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    c->fn = fn;
+    c->arg = arg;
+    c->local = NULL;
+    c->stack = stack;
+    c->state = CORO_RUNNABLE;
+    c->timed = 0;
+    getcontext(&c->context);
+    c->context.uc_stack.ss_sp = stack;
+    c->context.uc_stack.ss_size = CORO_STACK;
+    c->context.uc_link = &scheduler;
+    makecontext(&c->context, coro_main, 0);
+    coros[n_coros++] = c;
+}
+
+
+void coro_run(void)
+{
+    int alive = n_coros;
+    while (alive > 0)
+    {
+        // One round: every runnable coroutine runs until it waits or returns
+        for (int i = 0; i < n_coros; i++)
+        {
+            Coro *c = coros[i];
+            if (c->state != CORO_RUNNABLE)
+                continue;
+            current = c;
+            swapcontext(&scheduler, &c->context);
+            current = NULL;
+            if (c->state == CORO_FINISHED)
+            {
+                free(c->stack);
+                c->stack = NULL;
+                alive--;
+            }
+        }
+
+        // Wake the waiting coroutines after a signal, and every coroutine whose deadline has passed
+        int wake_all = signalled;
+        signalled = 0;
+        int runnable = 0;
+        int timed = 0;
+        struct timespec now, earliest;
+        clock_gettime(CLOCK_REALTIME, &now);
+        for (int i = 0; i < n_coros; i++)
+        {
+            Coro *c = coros[i];
+            if (c->state == CORO_WAITING && wake_all)
+                c->state = CORO_RUNNABLE;
+            else if ((c->state == CORO_SLEEPING || (c->state == CORO_WAITING && c->timed))
+                     && !time_before(&now, &c->deadline))
+                c->state = CORO_RUNNABLE;
+            else if (c->state == CORO_SLEEPING || (c->state == CORO_WAITING && c->timed))
+            {
+                if (!timed || time_before(&c->deadline, &earliest))
+                    earliest = c->deadline;
+                timed = 1;
+            }
+            runnable += c->state == CORO_RUNNABLE;
+        }
+
+        // Every coroutine waits: sleep until the first deadline
+        if (runnable == 0 && alive > 0)
+        {
+            if (!timed)
+            {
+                printf("Error! Every coroutine waits\n");
+                exit(1);
+            }
+            clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &earliest, NULL);
+        }
+    }
+
+    for (int i = 0; i < n_coros; i++)
+        free(coros[i]);
+    free(coros);
+    coros = NULL;
+    n_coros = 0;
+    max_coros = 0;
+}
+
+
+void coro_yield(void)
+{
+    if (current == NULL)
+    {
+        sched_yield();
+        return;
+    }
+    coro_switch(CORO_RUNNABLE);
+}
+
+
+void coro_wait(void)
+{
+    current->timed = 0;
+    coro_switch(CORO_WAITING);
+}
+
+
+void coro_wait_until(const struct timespec *deadline)
+{
+    current->timed = 1;
+    current->deadline = *deadline;
+    coro_switch(CORO_WAITING);
+}
+
+
+void coro_signal(void)
+{
+    signalled = 1;
+}
+
+
+void coro_sleep_until(const struct timespec *deadline)
+{
+    if (current == NULL)
+    {
+        while (clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, deadline, NULL) == EINTR)
+            ;
+        return;
+    }
+    current->deadline = *deadline;
+    coro_switch(CORO_SLEEPING);
+}
+
+
+void coro_usleep(unsigned us)
+{
+    if (current == NULL)
+    {
+        usleep(us);
+        return;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += us / 1000000;
+    deadline.tv_nsec += (us % 1000000) * 1000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    coro_sleep_until(&deadline);
+}
+
+
+void coro_sem_wait(sem_t *s)
+{
+    // Only a wait that blocks is timed
+    if (sem_trywait(s) == 0)
+        return;
+    uint64_t begin = telemetry_wait_begin();
+    if (current == NULL)
+    {
+        while (sem_wait(s) != 0)
+            ;
+    }
+    else
+    {
+        while (sem_trywait(s) != 0)
+            coro_wait();
+    }
+    telemetry_wait_end(begin);
+}
+
+
+int coro_sem_timedwait(sem_t *s, const struct timespec *deadline)
+{
+    if (sem_trywait(s) == 0)
+        return 0;
+    uint64_t begin = telemetry_wait_begin();
+    int result = 0;
+    if (current == NULL)
+        result = sem_timedwait(s, deadline);
+    else
+    {
+        while (sem_trywait(s) != 0)
+        {
+            struct timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+            if (!time_before(&now, deadline))
+            {
+                errno = ETIMEDOUT;
+                result = -1;
+                break;
+            }
+            coro_wait_until(deadline);
+        }
+    }
+    telemetry_wait_end(begin);
+    return result;
+}
+
+
+void coro_sem_post(sem_t *s)
+{
+    sem_post(s);
+    if (current != NULL)
+        signalled = 1;
+}
@@ -0,0 +1,138 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_CORO_H
+#define EX3_CORO_H
+
+#include <semaphore.h>
+#include <time.h>
+
+#define CORO_STACK (1 << 18)
+
+
+/*
+ * Coroutine runtime: the whole pipeline as cooperative coroutines on the main thread (RUNTIME=coroutines).
+ *
+ * The coroutines are ucontext contexts run round-robin by coro_run. A coroutine runs until it has to wait:
+ * the blocking points of the queues (semaphores, Event) and the sleeps of the
+ * editors call the coro_ functions below, which yield to the next coroutine inside the runtime and behave
+ * like the plain calls outside of it. A waiting coroutine runs again after another one signalled
+ * (coro_sem_post, event_signal) or when its deadline has passed, and then checks its condition again.
+ * When every coroutine waits, the runtime sleeps until the earliest deadline.
+ *
+ * Only one coroutine runs at a time and none yields while it holds a mutex, so the mutexes of the
+ * queues are never contended. Times are CLOCK_REALTIME, like the timed waits of the queues.
+ */
+
+
+/*
+ * coro_active - Returns 1 when called from a coroutine, 0 from a thread.
+ */
+int coro_active(void);
+
+
+/*
+ * coro_local - Slot of the calling coroutine for data a thread would keep thread-local.
+ *
+ * Return:
+ *  void** - The slot, NULL when called from a thread.
+ */
+void **coro_local(void);
+
+
+/*
+ * coro_spawn - Create a coroutine. It starts with coro_run.
+ *
+ * Parameters:
+ *  void* (*fn)(void*) - Function of the coroutine, a thread function.
+ *  void* arg - Argument of the function.
+ */
+void coro_spawn(void *(*fn)(void *), void *arg);
+
+
+/*
+ * coro_run - Run the coroutines on the calling thread until all of them returned.
+ * Exits if every coroutine waits for a signal that can no longer come.
+ */
+void coro_run(void);
+
+
+/*
+ * coro_yield - Let the other coroutines run, or the other threads (sched_yield) outside of the runtime.
+ */
+void coro_yield(void);
+
+
+/*
+ * coro_wait - Yield until another coroutine signals. Inside the runtime only.
+ */
+void coro_wait(void);
+
+
+/*
+ * coro_wait_until - Yield until another coroutine signals or the deadline passes. Inside the runtime only.
+ *
+ * Parameters:
+ *  const struct timespec* deadline - Absolute CLOCK_REALTIME time.
+ */
+void coro_wait_until(const struct timespec *deadline);
+
+
+/*
+ * coro_signal - Wake the waiting coroutines, they check their conditions again. Inside the runtime only.
+ */
+void coro_signal(void);
+
+
+/*
+ * coro_sleep_until - Sleep until the deadline: a coroutine yields, a thread calls clock_nanosleep.
+ *
+ * Parameters:
+ *  const struct timespec* deadline - Absolute CLOCK_REALTIME time.
+ */
+void coro_sleep_until(const struct timespec *deadline);
+
+
+/*
+ * coro_usleep - Sleep for a number of microseconds, like usleep.
+ *
+ * Parameters:
+ *  unsigned us - Time in microseconds.
+ */
+void coro_usleep(unsigned us);
+
+
+/*
+ * coro_sem_wait - sem_wait that yields inside the runtime.
+ *
+ * Parameters:
+ *  sem_t* s - Pointer to the semaphore.
+ */
+void coro_sem_wait(sem_t *s);
+
+
+/*
+ * coro_sem_timedwait - sem_timedwait that yields inside the runtime.
+ *
+ * Parameters:
+ *  sem_t* s - Pointer to the semaphore.
+ *  const struct timespec* deadline - Absolute CLOCK_REALTIME time.
+ *
+ * Return:
+ *  int - 0 on success, -1 with errno set (ETIMEDOUT at the deadline).
+ */
+int coro_sem_timedwait(sem_t *s, const struct timespec *deadline);
+
+
+/*
+ * coro_sem_post - sem_post that wakes the waiting coroutines inside the runtime.
+ *
+ * Parameters:
+ *  sem_t* s - Pointer to the semaphore.
+ */
+void coro_sem_post(sem_t *s);
+
+
+#endif //EX3_CORO_H
@@ -0,0 +1,132 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Edit_Timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * time_before - Returns 1 if time a is earlier than time b.
+ */
+static int time_before(const struct timespec *a, const struct timespec *b)
+{
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+
+/*
+ * next_lane - Index of the lane whose head finishes first, -1 if every lane is empty.
+ */
+static int next_lane(Edit_Timer *t)
+{
+    int best = -1;
+    for (int c = 0; c < N_CO_EDIT; c++)
+    {
+        Edit_Lane *l = &t->lanes[c];
+        if (l->count == 0)
+            continue;
+        if (best < 0 || time_before(&l->slots[l->head].deadline,
+                                    &t->lanes[best].slots[t->lanes[best].head].deadline))
+            best = c;
+    }
+    return best;
+}
+
+
+Edit_Timer *create_edit_timer(const int *edit_ms)
+{
+    Edit_Timer *t = (Edit_Timer *)malloc(sizeof(Edit_Timer));
+    if (t == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    for (int c = 0; c < N_CO_EDIT; c++)
+    {
+        t->lanes[c].capacity = 16;
+        t->lanes[c].slots = (Edit_Slot *)malloc(16 * sizeof(Edit_Slot));
+        t->lanes[c].head = 0;
+        t->lanes[c].count = 0;
+        if (t->lanes[c].slots == NULL)
+        {
+            printf("Error! Memory allocating\n");
+            exit(1);
+        }
+        t->latency[c].tv_sec = edit_ms[c] / 1000;
+        t->latency[c].tv_nsec = (edit_ms[c] % 1000) * 1000000L;
+    }
+    t->pending = 0;
+    return t;
+}
+
+
+void edit_timer_add(Edit_Timer *t, Item news, const struct timespec *now)
+{
+    int c = ITEM_NEWS(news)->category;
+    Edit_Lane *l = &t->lanes[c];
+    if (l->count == l->capacity)
+    {
+        Edit_Slot *slots = (Edit_Slot *)malloc(2 * l->capacity * sizeof(Edit_Slot));
+        if (slots == NULL)
+        {
+            printf("Error! Memory allocating\n");
+            exit(1);
+        }
+        for (int i = 0; i < l->count; i++)
+            slots[i] = l->slots[(l->head + i) & (l->capacity - 1)];
+        free(l->slots);
+        l->slots = slots;
+        l->capacity *= 2;
+        l->head = 0;
+    }
+
+    Edit_Slot *s = &l->slots[(l->head + l->count) & (l->capacity - 1)];
+    s->news = news;
+    s->deadline.tv_sec = now->tv_sec + t->latency[c].tv_sec;
+    s->deadline.tv_nsec = now->tv_nsec + t->latency[c].tv_nsec;
+    if (s->deadline.tv_nsec >= 1000000000L)
+    {
+        s->deadline.tv_sec++;
+        s->deadline.tv_nsec -= 1000000000L;
+    }
+    l->count++;
+    t->pending++;
+}
+
+
+int edit_timer_next(Edit_Timer *t, struct timespec *deadline)
+{
+    int c = next_lane(t);
+    if (c < 0)
+        return -1;
+    *deadline = t->lanes[c].slots[t->lanes[c].head].deadline;
+    return 0;
+}
+
+
+int edit_timer_expired(Edit_Timer *t, const struct timespec *now, Item *out)
+{
+    int c = next_lane(t);
+    if (c < 0)
+        return -1;
+    Edit_Lane *l = &t->lanes[c];
+    if (time_before(now, &l->slots[l->head].deadline))
+        return -1;
+    *out = l->slots[l->head].news;
+    l->head = (l->head + 1) & (l->capacity - 1);
+    l->count--;
+    t->pending--;
+    return 0;
+}
+
+
+void delete_edit_timer(Edit_Timer *t)
+{
+    for (int c = 0; c < N_CO_EDIT; c++)
+        free(t->lanes[c].slots);
+    free(t);
+}
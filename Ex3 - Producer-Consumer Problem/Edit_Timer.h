@@ -0,0 +1,123 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_EDIT_TIMER_H
+#define EX3_EDIT_TIMER_H
+
+#include "News.h"
+#include <time.h>
+
+
+/*
+ * Struct: Edit_Slot
+ * Description: A story being edited and the time its editing is over.
+ */
+typedef struct
+{
+    Item news;
+    struct timespec deadline;
+} Edit_Slot;
+
+
+/*
+ * Struct: Edit_Lane
+ * Description: Growable ring buffer of the stories of one category, oldest deadline first.
+ *
+ * Members:
+ *  - slots: Ring buffer of 'capacity' slots (a power of two)
+ *  - head: Index of the oldest slot
+ *  - count: Number of slots
+ */
+typedef struct
+{
+    Edit_Slot *slots;
+    int capacity;
+    int head;
+    int count;
+} Edit_Lane;
+
+
+/*
+ * Struct: Edit_Timer
+ * Description: Stories in editing of one co-editor, each released when its edit latency has passed.
+ *
+ * The latency is fixed per category, so the stories of a category finish in the order they came:
+ * every category is a FIFO lane and the next story to finish is the earliest of the lane heads.
+ * Adding and releasing a story are O(1), a timer wheel or heap is not needed.
+ * Times are CLOCK_REALTIME, the clock of sem_timedwait.
+ *
+ * Members:
+ *  - lanes: One lane per category
+ *  - latency: Edit latency of every category
+ *  - pending: Number of stories in editing
+ */
+typedef struct
+{
+    Edit_Lane lanes[N_CO_EDIT];
+    struct timespec latency[N_CO_EDIT];
+    int pending;
+} Edit_Timer;
+
+
+/*
+ * create_edit_timer - Create an edit timer.
+ *
+ * Parameters:
+ *  const int* edit_ms - Edit latency of every category in milliseconds.
+ *
+ * Return:
+ *  Edit_Timer* - Pointer to the new timer.
+ */
+Edit_Timer *create_edit_timer(const int *edit_ms);
+
+
+/*
+ * edit_timer_add - Start editing a story.
+ *
+ * Parameters:
+ *  Edit_Timer* t - Pointer to the timer.
+ *  Item news - The story, not a "DONE".
+ *  const struct timespec* now - Current time.
+ */
+void edit_timer_add(Edit_Timer *t, Item news, const struct timespec *now);
+
+
+/*
+ * edit_timer_next - Time the next story finishes.
+ *
+ * Parameters:
+ *  Edit_Timer* t - Pointer to the timer.
+ *  struct timespec* deadline - Receives the time.
+ *
+ * Return:
+ *  int - 0 on success, -1 if no story is in editing.
+ */
+int edit_timer_next(Edit_Timer *t, struct timespec *deadline);
+
+
+/*
+ * edit_timer_expired - Take a story whose editing is over, the earliest first.
+ *
+ * Parameters:
+ *  Edit_Timer* t - Pointer to the timer.
+ *  const struct timespec* now - Current time.
+ *  Item* out - Receives the story.
+ *
+ * Return:
+ *  int - 0 on success, -1 if no story is finished.
+ */
+int edit_timer_expired(Edit_Timer *t, const struct timespec *now, Item *out);
+
+
+/*
+ * delete_edit_timer - Delete an edit timer. Stories still in editing are not freed.
+ *
+ * Parameters:
+ *  Edit_Timer* t - Pointer to the timer.
+ */
+void delete_edit_timer(Edit_Timer *t);
+
+
+#endif //EX3_EDIT_TIMER_H
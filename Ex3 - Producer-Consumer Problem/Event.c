@@ -0,0 +1,94 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Event.h"
+#include "Coro.h"
+#include "Telemetry.h"
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+
+void event_init(Event *e)
+{
+    atomic_init(&e->seq, 0);
+    atomic_init(&e->waiters, 0);
+}
+
+
+unsigned event_prepare(Event *e)
+{
+    // Orders the announcement before the caller checks the condition again, pairs with event_signal.
+    atomic_fetch_add(&e->waiters, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    return atomic_load(&e->seq);
+}
+
+
+void event_wait(Event *e, unsigned key)
+{
+    // Returns at once if a signal came after event_prepare.
+    uint64_t begin = telemetry_wait_begin();
+    if (coro_active())
+    {
+        if (atomic_load(&e->seq) == key)
+            coro_wait();
+    }
+    else
+        syscall(SYS_futex, &e->seq, FUTEX_WAIT_PRIVATE, key, NULL, NULL, 0);
+    telemetry_wait_end(begin);
+    atomic_fetch_sub(&e->waiters, 1);
+}
+
+
+void event_wait_until(Event *e, unsigned key, const struct timespec *deadline)
+{
+    uint64_t begin = telemetry_wait_begin();
+    if (coro_active())
+    {
+        if (atomic_load(&e->seq) == key)
+            coro_wait_until(deadline);
+        telemetry_wait_end(begin);
+        atomic_fetch_sub(&e->waiters, 1);
+        return;
+    }
+
+    // FUTEX_WAIT takes a relative timeout.
+    struct timespec now, timeout;
+    clock_gettime(CLOCK_REALTIME, &now);
+    timeout.tv_sec = deadline->tv_sec - now.tv_sec;
+    timeout.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+    if (timeout.tv_nsec < 0)
+    {
+        timeout.tv_sec--;
+        timeout.tv_nsec += 1000000000L;
+    }
+    if (timeout.tv_sec >= 0)
+        syscall(SYS_futex, &e->seq, FUTEX_WAIT_PRIVATE, key, &timeout, NULL, 0);
+    telemetry_wait_end(begin);
+    atomic_fetch_sub(&e->waiters, 1);
+}
+
+
+void event_cancel(Event *e)
+{
+    atomic_fetch_sub(&e->waiters, 1);
+}
+
+
+void event_signal(Event *e)
+{
+    // Orders the caller's update before reading 'waiters', pairs with event_prepare.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&e->waiters, memory_order_relaxed) == 0)
+        return;
+    atomic_fetch_add(&e->seq, 1);
+    if (coro_active())
+        coro_signal();
+    else
+        syscall(SYS_futex, &e->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
@@ -0,0 +1,93 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_EVENT_H
+#define EX3_EVENT_H
+
+#include <stdatomic.h>
+#include <time.h>
+
+
+/*
+ * Struct: Event
+ * Description: Event count for waiting on a condition of a lock-free queue, built on a futex.
+ *
+ * A waiter announces itself with event_prepare, checks the condition again, and sleeps with event_wait
+ * only if it is still false. A signaller changes the state first and then calls event_signal,
+ * which costs a single atomic load when nobody waits.
+ * Inside the coroutine runtime (Coro.h) waiting yields to the other coroutines instead of the futex.
+ *
+ * Members:
+ *  - seq: Incremented by every signal that wakes waiters, the futex word
+ *  - waiters: Number of threads between event_prepare and the end of event_wait / event_cancel
+ */
+typedef struct
+{
+    atomic_uint seq;
+    atomic_int waiters;
+} Event;
+
+
+/*
+ * event_init - Initialize an event.
+ *
+ * Parameters:
+ *  Event* e - Pointer to the event.
+ */
+void event_init(Event *e);
+
+
+/*
+ * event_prepare - Announce a waiter. The condition must be checked again after this call.
+ *
+ * Parameters:
+ *  Event* e - Pointer to the event.
+ *
+ * Return:
+ *  unsigned - Key to pass to event_wait.
+ */
+unsigned event_prepare(Event *e);
+
+
+/*
+ * event_wait - Sleep until the event is signalled after event_prepare returned the key.
+ *
+ * Parameters:
+ *  Event* e - Pointer to the event.
+ *  unsigned key - Value returned by event_prepare.
+ */
+void event_wait(Event *e, unsigned key);
+
+
+/*
+ * event_wait_until - Like event_wait, but returns at the deadline at the latest.
+ *
+ * Parameters:
+ *  Event* e - Pointer to the event.
+ *  unsigned key - Value returned by event_prepare.
+ *  const struct timespec* deadline - Absolute CLOCK_REALTIME time.
+ */
+void event_wait_until(Event *e, unsigned key, const struct timespec *deadline);
+
+
+/*
+ * event_cancel - Withdraw a waiter whose condition became true after event_prepare.
+ *
+ * Parameters:
+ *  Event* e - Pointer to the event.
+ */
+void event_cancel(Event *e);
+
+
+/*
+ * event_signal - Wake every waiter of the event.
+ *
+ * Parameters:
+ *  Event* e - Pointer to the event.
+ */
+void event_signal(Event *e);
+
+
+#endif //EX3_EVENT_H
@@ -0,0 +1,62 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Hand_Off.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+Hand_Off *create_hand_off(int n)
+{
+    Hand_Off *h = (Hand_Off *)malloc(sizeof(Hand_Off));
+    if (h == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    h->n = n;
+    h->next = (atomic_int *)malloc(n * N_CO_EDIT * sizeof(atomic_int));
+    if (h->next == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    for (int i = 0; i < n * N_CO_EDIT; i++)
+        atomic_init(&h->next[i], 0);
+    for (int c = 0; c < N_CO_EDIT; c++)
+        event_init(&h->turn[c]);
+    return h;
+}
+
+
+void hand_off_wait(Hand_Off *h, int producer, int category, int index)
+{
+    atomic_int *next = &h->next[producer * N_CO_EDIT + category];
+    while (atomic_load(next) != index)
+    {
+        unsigned key = event_prepare(&h->turn[category]);
+        if (atomic_load(next) == index)
+        {
+            event_cancel(&h->turn[category]);
+            break;
+        }
+        event_wait(&h->turn[category], key);
+    }
+}
+
+
+void hand_off_next(Hand_Off *h, int producer, int category)
+{
+    atomic_fetch_add(&h->next[producer * N_CO_EDIT + category], 1);
+    event_signal(&h->turn[category]);
+}
+
+
+void delete_hand_off(Hand_Off *h)
+{
+    free(h->next);
+    free(h);
+}
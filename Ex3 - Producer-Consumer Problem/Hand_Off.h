@@ -0,0 +1,80 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_HAND_OFF_H
+#define EX3_HAND_OFF_H
+
+#include "News.h"
+#include "Event.h"
+#include <stdatomic.h>
+
+
+/*
+ * Struct: Hand_Off
+ * Description: Turns of the editors of a category that share its editor queue (EDIT_CATEGORY, EDITORS > 1).
+ *
+ * The editors take the stories of their queue in order, but finish them in any order. A producer numbers
+ * the stories of every category from 0, so an editor puts a story into the shared queue only once the
+ * story before it of the same producer and category is there, and the screen sees every producer in order.
+ * The story before it was taken earlier and is on its way already, so the wait is short.
+ *
+ * Members:
+ *  - n: Number of producer indexes
+ *  - next: Index of the next story to hand off, of every producer and category
+ *  - turn: Signalled after a story of the category is handed off, one per category
+ */
+typedef struct
+{
+    int n;
+    atomic_int *next;
+    Event turn[N_CO_EDIT];
+} Hand_Off;
+
+
+/*
+ * create_hand_off - Create the turns of the editors.
+ *
+ * Parameters:
+ *  int n - Number of producer indexes, the largest producer index plus one.
+ *
+ * Return:
+ *  Hand_Off* - Pointer to the new turns.
+ */
+Hand_Off *create_hand_off(int n);
+
+
+/*
+ * hand_off_wait - Wait until a story is the next one of its producer and category.
+ *
+ * Parameters:
+ *  Hand_Off* h - Pointer to the turns.
+ *  int producer - Producer index of the story.
+ *  int category - Category of the story.
+ *  int index - Index of the story.
+ */
+void hand_off_wait(Hand_Off *h, int producer, int category, int index);
+
+
+/*
+ * hand_off_next - Pass the turn on after a story is in the shared queue.
+ *
+ * Parameters:
+ *  Hand_Off* h - Pointer to the turns.
+ *  int producer - Producer index of the story.
+ *  int category - Category of the story.
+ */
+void hand_off_next(Hand_Off *h, int producer, int category);
+
+
+/*
+ * delete_hand_off - Delete the turns.
+ *
+ * Parameters:
+ *  Hand_Off* h - Pointer to the turns.
+ */
+void delete_hand_off(Hand_Off *h);
+
+
+#endif //EX3_HAND_OFF_H
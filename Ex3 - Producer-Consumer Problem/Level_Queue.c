@@ -0,0 +1,128 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Level_Queue.h"
+#include "Coro.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+Level_Queue *create_level_queue(int kind, int size, int n, int age)
+{
+    Level_Queue *q = (Level_Queue *)malloc(sizeof(Level_Queue));
+    if (q == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    q->n = n;
+    q->age = age;
+    q->pending = 0;
+    q->ready = NULL;
+    q->bounded = n > 1 && kind != QUEUE_UNBOUNDED && kind != QUEUE_CHUNKED;
+    if (q->bounded)
+        sem_init(&q->space, 0, size);
+    for (int l = 0; l < n; l++)
+    {
+        q->levels[l] = create_channel(kind, size);
+        q->passed[l] = 0;
+    }
+
+    // Every level can hold 'size' stories, so a put that got a place never waits on its channel.
+    // A single level is read straight from its channel, it needs no readiness set.
+    if (n > 1)
+    {
+        q->ready = create_ready_set(n);
+        for (int l = 0; l < n; l++)
+            channel_watch(q->levels[l], q->ready, l);
+    }
+    return q;
+}
+
+
+void level_queue_put(Level_Queue *q, Item n)
+{
+    int level = ITEM_NEWS(n)->priority;
+    if (q->bounded)
+        coro_sem_wait(&q->space);
+    channel_put(q->levels[level < q->n ? level : q->n - 1], n);
+}
+
+
+void level_queue_done(Level_Queue *q, Item done)
+{
+    for (int l = 0; l < q->n; l++)
+    {
+        if (q->bounded)
+            coro_sem_wait(&q->space);
+        channel_put(q->levels[l], l < q->n - 1 ? make_item(DONE, DONE, DONE) : done);
+    }
+}
+
+
+/*
+ * pick_level - Level to serve next: the one passed over the longest once it reached the age,
+ * otherwise the most urgent level with stories. 'pending' is not empty.
+ */
+static int pick_level(Level_Queue *q)
+{
+    int level = -1;
+    for (int l = 0; l < q->n; l++)
+    {
+        if ((q->pending >> l & 1) && q->passed[l] >= q->age && (level < 0 || q->passed[l] > q->passed[level]))
+            level = l;
+    }
+    return level >= 0 ? level : __builtin_ctzl(q->pending);
+}
+
+
+int level_queue_get_many(Level_Queue *q, Item *out, int max, int wait)
+{
+    if (q->n == 1)
+        return wait ? channel_get_many(q->levels[0], out, max) : channel_try_get_many(q->levels[0], out, max);
+
+    while (1)
+    {
+        ready_collect(q->ready, &q->pending, wait);
+        if (q->pending == 0)
+            return 0;
+
+        // An empty level stays quiet until a put marks it again
+        int level = pick_level(q);
+        int count = channel_try_get_many(q->levels[level], out, max);
+        q->passed[level] = 0;
+        if (count == 0)
+        {
+            q->pending &= ~(1UL << level);
+            continue;
+        }
+
+        // Give the places back, then count one more take for the other levels with stories
+        if (q->bounded)
+        {
+            for (int i = 0; i < count; i++)
+                coro_sem_post(&q->space);
+        }
+        for (int l = 0; l < q->n; l++)
+        {
+            if (l != level && (q->pending >> l & 1))
+                q->passed[l]++;
+        }
+        return count;
+    }
+}
+
+
+void delete_level_queue(Level_Queue *q)
+{
+    for (int l = 0; l < q->n; l++)
+        delete_channel(q->levels[l]);
+    if (q->ready != NULL)
+        delete_ready_set(q->ready);
+    if (q->bounded)
+        sem_destroy(&q->space);
+    free(q);
+}
@@ -0,0 +1,109 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_LEVEL_QUEUE_H
+#define EX3_LEVEL_QUEUE_H
+
+#include "Channel.h"
+#include "Ready.h"
+#include <semaphore.h>
+
+
+/*
+ * Struct: Level_Queue
+ * Description: Multi-level queue with one consumer: a channel per priority level.
+ *
+ * A story goes to the channel of its priority, level 0 is the most urgent. The consumer takes from the
+ * most urgent level that has stories, so urgent stories overtake a backlog of the others.
+ * Aging bounds the wait of the other levels: a level that had stories while 'age' takes went to
+ * more urgent levels is served next, whatever is waiting above it.
+ * The channels mark a Ready_Set, the consumer sleeps on it while every level is empty.
+ * With a bounded queue kind the levels share the configured capacity: a put waits on 'space' first,
+ * so the levels together never hold more than 'size' stories and the producers keep their backpressure.
+ *
+ * Members:
+ *  - n: Number of levels, a story of a higher priority goes to the last level
+ *  - levels: Channel of every level
+ *  - ready: Marked by the channels after every put
+ *  - bounded: The levels share 'space', with more than one level of a bounded queue kind
+ *  - space: Free places of all levels together
+ *  - age: Takes a level with stories may be passed over
+ *  - pending: Levels the consumer knows to have stories, one bit per level. Consumer only.
+ *  - passed: Takes every level has been passed over since it was last served. Consumer only.
+ */
+typedef struct
+{
+    int n;
+    Channel *levels[PRIORITY_LEVELS];
+    Ready_Set *ready;
+    int bounded;
+    sem_t space;
+    int age;
+    unsigned long pending;
+    int passed[PRIORITY_LEVELS];
+} Level_Queue;
+
+
+/*
+ * create_level_queue - Create a multi-level queue.
+ *
+ * Parameters:
+ *  int kind - QUEUE_KIND of the channel of every level.
+ *  int size - Capacity of all levels together, ignored by the unbounded kinds.
+ *  int n - Number of levels, 1 to PRIORITY_LEVELS. A single level is a plain FIFO channel.
+ *  int age - Takes a level with stories may be passed over, at least 1.
+ *
+ * Return:
+ *  Level_Queue* - Pointer to the new queue.
+ */
+Level_Queue *create_level_queue(int kind, int size, int n, int age);
+
+
+/*
+ * level_queue_put - Put a story on the level of its priority, waiting while that level is full.
+ *
+ * Parameters:
+ *  Level_Queue* q - Pointer to the queue.
+ *  Item n - The story.
+ */
+void level_queue_put(Level_Queue *q, Item n);
+
+
+/*
+ * level_queue_done - Put a "DONE" on every level, after the stories the caller has put there.
+ * The consumer has all stories of a producer once it has taken its "DONE" from every level.
+ *
+ * Parameters:
+ *  Level_Queue* q - Pointer to the queue.
+ *  Item done - The "DONE", it goes to the last level and new ones to the others.
+ */
+void level_queue_done(Level_Queue *q, Item done);
+
+
+/*
+ * level_queue_get_many - Take up to max stories of one level. Consumer only.
+ *
+ * Parameters:
+ *  Level_Queue* q - Pointer to the queue.
+ *  Item* out - Array that receives the stories, in order.
+ *  int max - Size of 'out'.
+ *  int wait - If 1, sleep while every level is empty.
+ *
+ * Return:
+ *  int - Number of stories taken, 0 only if 'wait' is 0 and every level is empty.
+ */
+int level_queue_get_many(Level_Queue *q, Item *out, int max, int wait);
+
+
+/*
+ * delete_level_queue - Delete a multi-level queue and its channels.
+ *
+ * Parameters:
+ *  Level_Queue* q - Pointer to the queue.
+ */
+void delete_level_queue(Level_Queue *q);
+
+
+#endif //EX3_LEVEL_QUEUE_H
@@ -4,19 +4,157 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
 #include "News.h"
 
+_Static_assert(POOL_SLAB % POOL_CHAIN == 0, "A slab is cut into whole chains");
 
-News *create_new(int pr, int ind, int cat)
+
+/*
+ * Pool_Item - Memory of one News object. While the object is free it links the free lists instead.
+ *  - next: Next free object of the same chain, NULL at the end of the chain
+ *  - next_chain: Next chain of the shared pool, used by the first object of a chain
+ */
+typedef union Pool_Item
+{
+    News news;
+    struct {
+        union Pool_Item *next;
+        union Pool_Item *next_chain;
+    };
+} Pool_Item;
+
+
+/*
+ * Slab - Block of POOL_SLAB objects. Slabs are only released by delete_news_pool.
+ */
+typedef struct Slab
+{
+    struct Slab *next;
+    Pool_Item items[POOL_SLAB];
+} Slab;
+
+
+/*
+ * News_Cache - Free objects owned by one thread.
+ *  - cur: Objects handed out first, n_cur of them
+ *  - spare: A full chain kept back, so a thread that creates and deletes around a chain boundary does not hit the shared pool
+ */
+typedef struct
+{
+    Pool_Item *cur;
+    int n_cur;
+    Pool_Item *spare;
+} News_Cache;
+
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Pool_Item *pool_chains = NULL;
+static Slab *pool_slabs = NULL;
+static __thread News_Cache cache;
+
+
+/*
+ * get_chain - Take a full chain from the shared pool, carving a new slab if the pool is empty.
+ */
+static Pool_Item *get_chain()
 {
-    News *n = (News *)malloc(sizeof(News));
-    if (n == NULL)
+    pthread_mutex_lock(&pool_mutex);
+    Pool_Item *chain = pool_chains;
+    if (chain != NULL) {
+        pool_chains = chain->next_chain;
+        pthread_mutex_unlock(&pool_mutex);
+        return chain;
+    }
+
+    Slab *slab = (Slab *)malloc(sizeof(Slab));
+    if (slab == NULL)
     {
         printf("Error! Memory allocating\n");
         exit(1);
     }
+    slab->next = pool_slabs;
+    pool_slabs = slab;
+
+    // Link the objects into chains, keep the first chain and give the others to the pool.
+    for (int i = 0; i < POOL_SLAB; i++)
+        slab->items[i].next = (i + 1) % POOL_CHAIN == 0 ? NULL : &slab->items[i + 1];
+    for (int i = POOL_SLAB - POOL_CHAIN; i > 0; i -= POOL_CHAIN) {
+        slab->items[i].next_chain = pool_chains;
+        pool_chains = &slab->items[i];
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return &slab->items[0];
+}
+
+
+/*
+ * put_chain - Give a full chain back to the shared pool.
+ */
+static void put_chain(Pool_Item *chain)
+{
+    pthread_mutex_lock(&pool_mutex);
+    chain->next_chain = pool_chains;
+    pool_chains = chain;
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+
+News *create_new(int pr, int ind, int cat)
+{
+    // Refill the cache from the spare chain, or from the shared pool.
+    if (cache.cur == NULL)
+    {
+        if (cache.spare != NULL) {
+            cache.cur = cache.spare;
+            cache.spare = NULL;
+        }
+        else
+            cache.cur = get_chain();
+        cache.n_cur = POOL_CHAIN;
+    }
+    Pool_Item *item = cache.cur;
+    cache.cur = item->next;
+    cache.n_cur--;
+
+    News *n = &item->news;
     n->category = cat;
     n->index = ind;
     n->producer = pr;
+    n->created_us = 0;
+    n->priority = 0;
     return n;
-}
\ No newline at end of file
+}
+
+
+void delete_new(News *n)
+{
+    Pool_Item *item = (Pool_Item *)n;
+    item->next = cache.cur;
+    cache.cur = item;
+    cache.n_cur++;
+
+    // A full chain becomes the spare one, the previous spare goes back to the shared pool.
+    if (cache.n_cur == POOL_CHAIN)
+    {
+        if (cache.spare != NULL)
+            put_chain(cache.spare);
+        cache.spare = cache.cur;
+        cache.cur = NULL;
+        cache.n_cur = 0;
+    }
+}
+
+
+void delete_news_pool()
+{
+    while (pool_slabs != NULL) {
+        Slab *next = pool_slabs->next;
+        free(pool_slabs);
+        pool_slabs = next;
+    }
+    pool_chains = NULL;
+    cache.cur = NULL;
+    cache.n_cur = 0;
+    cache.spare = NULL;
+}
@@ -6,16 +6,54 @@
 #ifndef EX3_NEWS_H
 #define EX3_NEWS_H
 
+#define POOL_CHAIN 64
+#define POOL_SLAB 4096
 
+#define N_CO_EDIT 3
+
+// Priority levels of the stories, 0 is the most urgent.
+#define PRIORITY_LEVELS 3
+
+// Size of a cache line, fields written by different threads are kept this far apart.
+#define CACHE_LINE 64
+
+
+/*
+ * Categories of news, every category has its own editor queue.
+ * DONE marks the end of a producer or of an editor.
+ */
+enum CO_EDITORS {
+    DONE = -1,
+    SPORT,
+    NEWS,
+    WEATHER
+};
+
+
+/*
+ * Stages of the pipeline, in the order the news go through them.
+ */
+enum STAGE {STAGE_PRODUCER, STAGE_DISPATCHER, STAGE_EDITOR, STAGE_SCREEN, N_STAGES};
+
+
+/*
+ * News - A story.
+ *  - created_us: Time the story was produced on the telemetry clock, 0 without telemetry (see Telemetry.h)
+ *  - priority: Priority level, set by the producer (see Level_Queue.h)
+ */
 typedef struct
 {
     int producer;
     int index;
     int category;
+    unsigned created_us;
+    int priority;
 } News;
 
 /*
  * create_new - Create a new News object with the given parameters.
+ * News objects come from a pool of slabs: every thread keeps its own cache of free objects
+ * and exchanges them with the shared pool a chain of POOL_CHAIN objects at a time.
  * 
  * Parameters:
  *  int pr - Producer ID
@@ -27,4 +65,57 @@ typedef struct
  */
 News *create_new(int pr, int ind, int cat);
 
+
+/*
+ * delete_new - Give a News object back to the pool. Any thread may delete a News created by another one.
+ *
+ * Parameters:
+ *  News* n - Pointer to the News object
+ */
+void delete_new(News *n);
+
+
+/*
+ * delete_news_pool - Release the memory of the News pool. Called once, after every thread has finished.
+ */
+void delete_news_pool();
+
+
+/*
+ * Item - What the queues carry, a pointer to a pooled News by default.
+ * Built with INLINE_NEWS (make INLINE=1) a queue slot holds the News itself, copied in and out,
+ * so a story is never allocated or freed on its way through the pipeline.
+ *  - ITEM_NEWS(it): The News of the item variable 'it', as a pointer.
+ *  - make_item: Create an item.
+ *  - free_item: Release an item once it is no longer needed.
+ */
+#ifdef INLINE_NEWS
+typedef News Item;
+#define ITEM_NEWS(it) (&(it))
+
+static inline Item make_item(int pr, int ind, int cat)
+{
+    Item it = {pr, ind, cat, 0, 0};
+    return it;
+}
+
+static inline void free_item(Item it)
+{
+    (void)it;
+}
+#else
+typedef News *Item;
+#define ITEM_NEWS(it) (it)
+
+static inline Item make_item(int pr, int ind, int cat)
+{
+    return create_new(pr, ind, cat);
+}
+
+static inline void free_item(Item it)
+{
+    delete_new(it);
+}
+#endif
+
 #endif //EX3_NEWS_H
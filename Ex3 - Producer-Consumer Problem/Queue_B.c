@@ -5,19 +5,23 @@
 
 
 #include "Queue_B.h"
+#include "Coro.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 Queue_B *create_queue_b(int size)
 {
     // Allocate memory for the news array.
-    News **news = (News **)malloc(sizeof(News *) * size);
+    Item *news = (Item *)malloc(sizeof(Item) * size);
     if (news == NULL)
     {
         printf("Error! Memory allocating\n");
         exit(1);
     }
+    // Touch the slots now, so the first touch places them on the NUMA node of the creating thread.
+    memset(news, 0, sizeof(Item) * size);
 
     // Allocate memory for the Queue_B structure.
     Queue_B *q = (Queue_B *)malloc(sizeof(Queue_B));
@@ -27,13 +31,11 @@ Queue_B *create_queue_b(int size)
         exit(1);
     }
 
-    // Initialize the first news slot to NULL.
-    news[0] = NULL;
-
-    // Set the size, first, and last indices of the queue.
+    // Set the size, first, and last indices of the queue, it starts empty.
     q->size = size;
     q->first = 0;
     q->last = 0;
+    q->count = 0;
 
     // Set the news array and initialize synchronization primitives.
     q->news = news;
@@ -46,95 +48,131 @@ Queue_B *create_queue_b(int size)
 
 
 
-int enqueue_b_mut(Queue_B *q, News *n) {
-    sem_wait(&q->empty);        //decrease number of empty slots
+int enqueue_b_mut(Queue_B *q, Item n) {
+    coro_sem_wait(&q->empty);        //decrease number of empty slots
     pthread_mutex_lock(&q->mutex); //lock mutex
     int result = enqueue_b(q, n);
     pthread_mutex_unlock(&q->mutex);    //unlock mutex
-    sem_post(&q->full);             // increase number of full slots.
+    coro_sem_post(&q->full);             // increase number of full slots.
     return result;
 }
 
-int enqueue_b(Queue_B *q, News *n) {
-    // Check if the queue is initially empty.
-    if (q->first == q->last && q->news[q->first]== NULL)
-    {
-        q->news[q->first] = n;
-        return 0;
-    }
-
-    // Calculate the new index for the last element.
-    int new_ind = (q->last + 1) % q->size;
-
-    // Check if the new index is equal to the first index (queue is full).
-    if (new_ind == q->first){
+int enqueue_b(Queue_B *q, Item n) {
+    // Check if the queue is full.
+    if (q->count == q->size){
         return -1;
     }
 
     // Insert the news item and update the last index.
-    q->news[new_ind] = n;
-    q->last = new_ind;
+    q->news[q->last] = n;
+    q->last = (q->last + 1) % q->size;
+    q->count++;
 
     return 0;
 }
 
 
-News* dequeue_b_mut(Queue_B *q){
-    sem_wait(&q->full); // Wait until there are items to dequeue (full semaphore).
+Item dequeue_b_mut(Queue_B *q){
+    Item result = {0};    // Always set: the semaphore guarantees an item
+    coro_sem_wait(&q->full); // Wait until there are items to dequeue (full semaphore).
     pthread_mutex_lock(&q->mutex); // Lock the mutex
-    News* result = dequeue_b(q);
+    dequeue_b(q, &result);
     pthread_mutex_unlock(&q->mutex);
-    sem_post(&q->empty);    // Increment the 'empty' semaphore to indicate an available slot.
+    coro_sem_post(&q->empty);    // Increment the 'empty' semaphore to indicate an available slot.
     return result;
 }
 
 
-News* try_dequeue_b_mut(Queue_B *q){
+int try_dequeue_b_mut(Queue_B *q, Item *out){
 
     // Attempt to decrement the 'full' semaphore to check if there are items available.
     if (sem_trywait(&q->full) != 0)
-        return NULL;
+        return -1;
 
-    // Attempt to acquire the mutex lock for the queue.
-    if (pthread_mutex_trylock(&q->mutex)!= 0){
-        sem_post(&q->full);
-        return NULL;
-    }
+    // An item is reserved for us, the mutex is only held for a moment by the other side.
+    pthread_mutex_lock(&q->mutex);
     // Dequeue a news item from the queue.
-    News* result = dequeue_b(q);
+    dequeue_b(q, out);
     pthread_mutex_unlock(&q->mutex);
-    sem_post(&q->empty);
-    return result;
+    coro_sem_post(&q->empty);
+    return 0;
 }
 
 
 
 
-News *dequeue_b(Queue_B *q)
+int dequeue_b(Queue_B *q, Item *out)
 {
-    News *n;
-
-    // Check if the queue is empty (first == last).
-    if (q->first == q->last)
+    // Check if the queue is empty.
+    if (q->count == 0)
     {
-        // If the slot is NULL, return NULL (queue is empty).
-        if (q->news[q->first] == NULL)
-        {
-            return NULL;
-        }
-        // Dequeue the news item from the front of the queue.
-        n = q->news[q->first];
-        q->news[q->first] = NULL;      // Set clot to NULL
-        return n;
+        return -1;
     }
 
     // Dequeue the news item from the front of the queue.
-    n = q->news[q->first];
-    q->news[q->first] = NULL;
+    *out = q->news[q->first];
     q->first = (q->first + 1)% q->size;     // Update the 'first' index
-    return n;
+    q->count--;
+    return 0;
+}
+
+/*
+ * take_b_many - Dequeue 'count' reserved items under the mutex and free their slots.
+ */
+static int take_b_many(Queue_B *q, Item *out, int count){
+    pthread_mutex_lock(&q->mutex);
+    for (int i = 0; i < count; i++)
+        dequeue_b(q, &out[i]);
+    pthread_mutex_unlock(&q->mutex);
+    for (int i = 0; i < count; i++)
+        coro_sem_post(&q->empty);
+    return count;
 }
 
+
+int enqueue_b_many(Queue_B *q, Item *items, int n){
+    if (n <= 0)
+        return 0;
+
+    // Wait for one free slot, then reserve the other free ones without waiting.
+    coro_sem_wait(&q->empty);
+    int count = 1;
+    while (count < n && sem_trywait(&q->empty) == 0)
+        count++;
+
+    pthread_mutex_lock(&q->mutex);
+    for (int i = 0; i < count; i++)
+        enqueue_b(q, items[i]);
+    pthread_mutex_unlock(&q->mutex);
+    for (int i = 0; i < count; i++)
+        coro_sem_post(&q->full);
+    return count;
+}
+
+
+int dequeue_b_many(Queue_B *q, Item *out, int max){
+    if (max <= 0)
+        return 0;
+
+    // Wait for one item, then reserve the other ready ones without waiting.
+    coro_sem_wait(&q->full);
+    int count = 1;
+    while (count < max && sem_trywait(&q->full) == 0)
+        count++;
+    return take_b_many(q, out, count);
+}
+
+
+int try_dequeue_b_many(Queue_B *q, Item *out, int max){
+    if (max <= 0 || sem_trywait(&q->full) != 0)
+        return 0;
+    int count = 1;
+    while (count < max && sem_trywait(&q->full) == 0)
+        count++;
+    return take_b_many(q, out, count);
+}
+
+
 void delete_queue_b(Queue_B* q){
     sem_destroy(&q->full);  // Destroy the 'full' semaphore.
     sem_destroy(&q->empty); // Destroy the 'empty' semaphore.
@@ -17,21 +17,23 @@
  * Members:
  *  - size: Size of the queue
  *  - first: Index of the first element in the queue
- *  - last: Index of the last element in the queue
+ *  - last: Index of the slot after the last element in the queue
+ *  - count: Number of elements in the queue
  *  - mutex: Mutex for queue synchronization
  *  - empty: Semaphore representing the number of empty slots in the queue
  *  - full: Semaphore representing the number of filled slots in the queue
- *  - news: Array of pointers to News structures (the actual news items)
+ *  - news: Array of items, pointers to News structures or the news themselves (see Item)
  */
 typedef struct
 {
     int size;
     int first;
     int last;
+    int count;
     pthread_mutex_t mutex;
     sem_t empty;
     sem_t full;
-    News **news;
+    Item *news;
 
 } Queue_B;
 
@@ -41,13 +43,13 @@ typedef struct
  * 
  * Parameters:
  *  - Queue_B* q: Pointer to the bounded queue struct
- *  - News* n: Pointer to the news item to insert
+ *  - Item n: The news item to insert
  * 
  * Return:
  *  - 0: Success
  *  - -1: Failure
  */
-int enqueue_b_mut(Queue_B *q, News *n);
+int enqueue_b_mut(Queue_B *q, Item n);
 
 
 /*
@@ -72,12 +74,12 @@ Queue_B *create_queue_b(int size);
  * 
  * Parameters:
  *  Queue_B* q - Pointer to the bounded queue.
- *  News* n - Pointer to the news item to be enqueued.
+ *  Item n - The news item to be enqueued.
  * 
  * Return:
  *  int - 0 on success, -1 if the queue is full.
  */
-int enqueue_b(Queue_B *q, News *n);
+int enqueue_b(Queue_B *q, Item n);
 
 
 /*
@@ -87,9 +89,9 @@ int enqueue_b(Queue_B *q, News *n);
  *  Queue_B* q - Pointer to the bounded queue.
  * 
  * Return:
- *  News* - Pointer to the dequeued news item.
+ *  Item - The dequeued news item.
  */
-News* dequeue_b_mut(Queue_B *q);
+Item dequeue_b_mut(Queue_B *q);
 
 
 /*
@@ -97,11 +99,12 @@ News* dequeue_b_mut(Queue_B *q);
  * 
  * Parameters:
  *  Queue_B* q - Pointer to the bounded queue.
+ *  Item* out - Receives the dequeued news item.
  * 
  * Return:
- *  News* - Pointer to the dequeued news item.
+ *  int - 0 on success, -1 if the queue is empty.
  */
-News *dequeue_b(Queue_B *q);
+int dequeue_b(Queue_B *q, Item *out);
 
 
 
@@ -110,14 +113,60 @@ News *dequeue_b(Queue_B *q);
  * 
  * Parameters:
  *  Queue_B* q - Pointer to the bounded queue.
+ *  Item* out - Receives the dequeued news item.
  * 
  * Return:
- *  News* - Pointer to the dequeued news item if successful, or NULL if not.
+ *  int - 0 if an item was dequeued, -1 if not.
  * 
  * Description:
- * If queue is empty, NULL will be return and will be no waiting.
+ * If queue is empty, -1 will be return and will be no waiting.
+ * -1 always means that the queue was empty, so a caller that is told a queue has data can rely on it.
  */
-News* try_dequeue_b_mut(Queue_B *q);
+int try_dequeue_b_mut(Queue_B *q, Item *out);
+
+
+/*
+ * enqueue_b_many - Enqueue several news items with a single lock acquisition.
+ * Waits until at least one slot is free, then takes as many free slots as there are, up to n.
+ *
+ * Parameters:
+ *  Queue_B* q - Pointer to the bounded queue.
+ *  Item* items - News items to insert, in order.
+ *  int n - Number of items.
+ *
+ * Return:
+ *  int - Number of items moved into the queue (the first ones of 'items'), at least 1 if n > 0.
+ */
+int enqueue_b_many(Queue_B *q, Item *items, int n);
+
+
+/*
+ * dequeue_b_many - Dequeue several news items with a single lock acquisition.
+ * Waits until at least one item is in the queue, then takes as many as there are, up to max.
+ *
+ * Parameters:
+ *  Queue_B* q - Pointer to the bounded queue.
+ *  Item* out - Array that receives the items, in order.
+ *  int max - Size of 'out'.
+ *
+ * Return:
+ *  int - Number of items dequeued, at least 1.
+ */
+int dequeue_b_many(Queue_B *q, Item *out, int max);
+
+
+/*
+ * try_dequeue_b_many - Like dequeue_b_many, but returns 0 at once if the queue is empty.
+ *
+ * Parameters:
+ *  Queue_B* q - Pointer to the bounded queue.
+ *  Item* out - Array that receives the items, in order.
+ *  int max - Size of 'out'.
+ *
+ * Return:
+ *  int - Number of items dequeued.
+ */
+int try_dequeue_b_many(Queue_B *q, Item *out, int max);
 
 
 /*
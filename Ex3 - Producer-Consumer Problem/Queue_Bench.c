@@ -0,0 +1,331 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ * Micro-benchmark of the queue implementations, through the Channel functions.
+ *
+ * Usage: Queue_Bench.out [KEY=VALUE ...]
+ *  - QUEUE: Queue kind (bounded, spsc, mpsc, unbounded, chunked, padded) or "all". Default all.
+ *  - PRODUCERS, CONSUMERS: Number of producer and consumer threads. Default 1 and 1.
+ *  - CAPACITY: Size of the bounded kinds. Default 1024.
+ *  - OPS: News items put by every producer. Default 1000000.
+ *  - BATCH: News items per put and get call (channel_put_many, channel_get_many). Default 1.
+ *
+ * The payload mode is the one of the build: pointers to News, or News held by value with make INLINE=1.
+ * Every call is timed with clock_gettime. The report gives the items moved per second, the latency
+ * percentiles of the put and get calls in nanoseconds, and the voluntary and involuntary context switches
+ * of the run from getrusage. Kinds that do not allow the thread counts (spsc, mpsc) are skipped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "Channel.h"
+
+#define BENCH_SAMPLES (1 << 18)
+
+
+/*
+ * Samples - Latencies of one thread. When 'cap' samples are kept, every other one is dropped
+ * and only every 'stride'-th call is recorded from then on, so long runs keep an even spread.
+ */
+typedef struct {
+    uint64_t *v;
+    int n;
+    int cap;
+    long stride;
+    long seen;
+    uint64_t max;
+} Samples;
+
+
+/*
+ * Bench_Arg - Arguments and results of a producer or consumer thread.
+ */
+typedef struct {
+    Channel *c;
+    int ops;
+    int batch;
+    int id;
+    pthread_barrier_t *start;
+    Samples lat;
+} Bench_Arg;
+
+
+static const char *kind_names[] = {"bounded", "spsc", "mpsc", "unbounded", "chunked", "padded"};
+static News done_news = {DONE, DONE, DONE};
+
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+
+/*
+ * bench_item - The item of a News in the payload mode of the build.
+ */
+static Item bench_item(News *n) {
+#ifdef INLINE_NEWS
+    return *n;
+#else
+    return n;
+#endif
+}
+
+
+static void samples_init(Samples *s) {
+    s->v = (uint64_t *) malloc(BENCH_SAMPLES * sizeof(uint64_t));
+    if (s->v == NULL) {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    s->n = 0;
+    s->cap = BENCH_SAMPLES;
+    s->stride = 1;
+    s->seen = 0;
+    s->max = 0;
+}
+
+
+static void samples_add(Samples *s, uint64_t ns) {
+    if (ns > s->max)
+        s->max = ns;
+    if (s->seen++ % s->stride != 0)
+        return;
+    if (s->n == s->cap) {
+        for (int i = 0; i < s->n / 2; i++)
+            s->v[i] = s->v[2 * i];
+        s->n /= 2;
+        s->stride *= 2;
+    }
+    s->v[s->n++] = ns;
+}
+
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+
+/*
+ * print_percentiles - Print p50/p99/p99.9/max of the samples of several threads.
+ */
+static void print_percentiles(Bench_Arg *args, int n) {
+    int total = 0;
+    uint64_t max = 0;
+    for (int i = 0; i < n; i++) {
+        total += args[i].lat.n;
+        if (args[i].lat.max > max)
+            max = args[i].lat.max;
+    }
+    uint64_t *all = (uint64_t *) malloc((total + 1) * sizeof(uint64_t));
+    if (all == NULL) {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        memcpy(all + k, args[i].lat.v, args[i].lat.n * sizeof(uint64_t));
+        k += args[i].lat.n;
+    }
+    qsort(all, total, sizeof(uint64_t), compare_u64);
+    if (total == 0)
+        all[0] = 0;
+    printf(" %7llu %7llu %7llu %9llu",
+           (unsigned long long) all[(long) total * 50 / 100],
+           (unsigned long long) all[(long) total * 99 / 100],
+           (unsigned long long) all[(long) total * 999 / 1000],
+           (unsigned long long) max);
+    free(all);
+}
+
+
+void *bench_produce(void *arg) {
+    Bench_Arg *a = (Bench_Arg *) arg;
+    News payload = {a->id, 0, SPORT};
+    Item *items = (Item *) malloc(a->batch * sizeof(Item));
+    if (items == NULL) {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    for (int i = 0; i < a->batch; i++)
+        items[i] = bench_item(&payload);
+
+    pthread_barrier_wait(a->start);
+    for (int i = 0; i < a->ops; i += a->batch) {
+        int count = a->ops - i < a->batch ? a->ops - i : a->batch;
+        uint64_t t0 = now_ns();
+        if (count == 1)
+            channel_put(a->c, items[0]);
+        else
+            channel_put_many(a->c, items, count);
+        samples_add(&a->lat, now_ns() - t0);
+    }
+    free(items);
+    return NULL;
+}
+
+
+void *bench_consume(void *arg) {
+    Bench_Arg *a = (Bench_Arg *) arg;
+    Item *items = (Item *) malloc(a->batch * sizeof(Item));
+    if (items == NULL) {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+
+    pthread_barrier_wait(a->start);
+    int is_consume = 1;
+    while (is_consume) {
+        uint64_t t0 = now_ns();
+        int count = 1;
+        if (a->batch == 1)
+            items[0] = channel_get(a->c);
+        else
+            count = channel_get_many(a->c, items, a->batch);
+        samples_add(&a->lat, now_ns() - t0);
+
+        // Keep one "DONE" and give back the ones meant for the other consumers
+        for (int i = 0; i < count; i++) {
+            if (ITEM_NEWS(items[i])->category != DONE)
+                continue;
+            if (is_consume)
+                is_consume = 0;
+            else
+                channel_put(a->c, items[i]);
+        }
+    }
+    free(items);
+    return NULL;
+}
+
+
+/*
+ * run - Benchmark one queue kind and print its line of the report.
+ */
+static void run(int kind, int n_prod, int n_cons, int capacity, int ops, int batch) {
+    if ((kind == QUEUE_SPSC && (n_prod != 1 || n_cons != 1)) || (kind == QUEUE_MPSC && n_cons != 1)) {
+        printf("%-10s skipped, %s allows %s\n", kind_names[kind], kind_names[kind],
+               kind == QUEUE_SPSC ? "1 producer and 1 consumer" : "1 consumer");
+        return;
+    }
+
+    Channel *c = create_channel(kind, capacity);
+    Bench_Arg *prod = (Bench_Arg *) malloc(n_prod * sizeof(Bench_Arg));
+    Bench_Arg *cons = (Bench_Arg *) malloc(n_cons * sizeof(Bench_Arg));
+    pthread_t *threads = (pthread_t *) malloc((n_prod + n_cons) * sizeof(pthread_t));
+    if (prod == NULL || cons == NULL || threads == NULL) {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, n_prod + n_cons + 1);
+
+    for (int i = 0; i < n_prod + n_cons; i++) {
+        Bench_Arg *a = i < n_prod ? &prod[i] : &cons[i - n_prod];
+        a->c = c;
+        a->ops = ops;
+        a->batch = batch;
+        a->id = i;
+        a->start = &start;
+        samples_init(&a->lat);
+        if (pthread_create(&threads[i], NULL, i < n_prod ? &bench_produce : &bench_consume, a) != 0)
+            exit(1);
+    }
+
+    struct rusage before, after;
+    getrusage(RUSAGE_SELF, &before);
+    pthread_barrier_wait(&start);
+    uint64_t t0 = now_ns();
+
+    // One "DONE" per consumer after all news
+    for (int i = 0; i < n_prod; i++)
+        pthread_join(threads[i], NULL);
+    for (int i = 0; i < n_cons; i++)
+        channel_put(c, bench_item(&done_news));
+    for (int i = n_prod; i < n_prod + n_cons; i++)
+        pthread_join(threads[i], NULL);
+
+    uint64_t elapsed = now_ns() - t0;
+    getrusage(RUSAGE_SELF, &after);
+
+    printf("%-10s %12.0f", kind_names[kind], (double) n_prod * ops * 1e9 / (double) elapsed);
+    print_percentiles(prod, n_prod);
+    print_percentiles(cons, n_cons);
+    printf(" %8ld %8ld\n", after.ru_nvcsw - before.ru_nvcsw, after.ru_nivcsw - before.ru_nivcsw);
+
+    for (int i = 0; i < n_prod; i++)
+        free(prod[i].lat.v);
+    for (int i = 0; i < n_cons; i++)
+        free(cons[i].lat.v);
+    pthread_barrier_destroy(&start);
+    free(threads);
+    free(prod);
+    free(cons);
+    delete_channel(c);
+}
+
+
+int main(int argc, char const *argv[]) {
+    int kind = -1, n_prod = 1, n_cons = 1, capacity = 1024, ops = 1000000, batch = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *eq = strchr(argv[i], '=');
+        if (eq == NULL) {
+            printf("Wrong argument %s\n", argv[i]);
+            return 1;
+        }
+        const char *value = eq + 1;
+        int n = atoi(value);
+        size_t len = eq - argv[i];
+        if (len == 5 && strncmp(argv[i], "QUEUE", len) == 0) {
+            kind = strcmp(value, "all") == 0 ? -1 : queue_kind(value);
+            if (kind < 0 && strcmp(value, "all") != 0) {
+                printf("Unknown queue %s\n", value);
+                return 1;
+            }
+            continue;
+        }
+        if (n < 1) {
+            printf("Wrong argument %s\n", argv[i]);
+            return 1;
+        }
+        if (len == 9 && strncmp(argv[i], "PRODUCERS", len) == 0)
+            n_prod = n;
+        else if (len == 9 && strncmp(argv[i], "CONSUMERS", len) == 0)
+            n_cons = n;
+        else if (len == 8 && strncmp(argv[i], "CAPACITY", len) == 0)
+            capacity = n;
+        else if (len == 3 && strncmp(argv[i], "OPS", len) == 0)
+            ops = n;
+        else if (len == 5 && strncmp(argv[i], "BATCH", len) == 0)
+            batch = n;
+        else {
+            printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+#ifdef INLINE_NEWS
+    const char *payload = "inline";
+#else
+    const char *payload = "pointer";
+#endif
+    printf("producers %d, consumers %d, capacity %d, ops %d per producer, batch %d, payload %s (%zu bytes)\n",
+           n_prod, n_cons, capacity, ops, batch, payload, sizeof(Item));
+    printf("latency of the put and get calls in ns\n");
+    printf("%-10s %12s %7s %7s %7s %9s %7s %7s %7s %9s %8s %8s\n", "queue", "items/s",
+           "put50", "put99", "put99.9", "put_max", "get50", "get99", "get99.9", "get_max", "vcsw", "ivcsw");
+
+    for (int k = QUEUE_BOUNDED; k <= QUEUE_PADDED; k++) {
+        if (kind < 0 || kind == k)
+            run(k, n_prod, n_cons, capacity, ops, batch);
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Queue_C.h"
+#include "Coro.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+
+/*
+ * new_segment - Take a spare segment, or allocate one. Called with the mutex held.
+ */
+static Segment *new_segment(Queue_C *q)
+{
+    Segment *seg = q->spare;
+    if (seg != NULL)
+    {
+        q->spare = seg->next;
+        q->n_spare--;
+    }
+    else
+    {
+        seg = (Segment *)malloc(sizeof(Segment));
+        if (seg == NULL)
+        {
+            printf("Error! Memory allocating\n");
+            exit(1);
+        }
+    }
+    seg->next = NULL;
+    return seg;
+}
+
+
+Queue_C *create_queue_c()
+{
+    Queue_C *q = (Queue_C *)malloc(sizeof(Queue_C));
+    if (q == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    q->spare = NULL;
+    q->n_spare = 0;
+    q->first = q->last = new_segment(q);
+    q->first_index = 0;
+    q->last_index = 0;
+    pthread_mutex_init(&q->mutex, NULL);
+    sem_init(&q->full, 0, 0);
+    return q;
+}
+
+
+/*
+ * put_c - Append an item. Called with the mutex held.
+ */
+static void put_c(Queue_C *q, Item news)
+{
+    // The last segment is full: link a new one.
+    if (q->last_index == SEGMENT_SIZE)
+    {
+        q->last->next = new_segment(q);
+        q->last = q->last->next;
+        q->last_index = 0;
+    }
+    q->last->news[q->last_index++] = news;
+}
+
+
+/*
+ * take_c - Remove the first item, the queue is not empty. Called with the mutex held.
+ */
+static Item take_c(Queue_C *q)
+{
+    // The first segment is drained: keep it as a spare or free it.
+    if (q->first_index == SEGMENT_SIZE)
+    {
+        Segment *seg = q->first;
+        q->first = seg->next;
+        q->first_index = 0;
+        if (q->n_spare < SPARE_SEGMENTS)
+        {
+            seg->next = q->spare;
+            q->spare = seg;
+            q->n_spare++;
+        }
+        else
+            free(seg);
+    }
+    return q->first->news[q->first_index++];
+}
+
+
+void enqueue_c_mut(Queue_C *q, Item news)
+{
+    pthread_mutex_lock(&q->mutex);
+    put_c(q, news);
+    pthread_mutex_unlock(&q->mutex);
+    coro_sem_post(&q->full);
+}
+
+
+void enqueue_c_many(Queue_C *q, Item *news, int n)
+{
+    if (n <= 0)
+        return;
+    pthread_mutex_lock(&q->mutex);
+    for (int i = 0; i < n; i++)
+        put_c(q, news[i]);
+    pthread_mutex_unlock(&q->mutex);
+    for (int i = 0; i < n; i++)
+        coro_sem_post(&q->full);
+}
+
+
+Item dequeue_c_mut(Queue_C *q)
+{
+    coro_sem_wait(&q->full);
+    pthread_mutex_lock(&q->mutex);
+    Item news = take_c(q);
+    pthread_mutex_unlock(&q->mutex);
+    return news;
+}
+
+
+int try_dequeue_c_mut(Queue_C *q, Item *out)
+{
+    if (sem_trywait(&q->full) != 0)
+        return -1;
+    pthread_mutex_lock(&q->mutex);
+    *out = take_c(q);
+    pthread_mutex_unlock(&q->mutex);
+    return 0;
+}
+
+
+int dequeue_c_until(Queue_C *q, Item *out, const struct timespec *deadline)
+{
+    while (coro_sem_timedwait(&q->full, deadline) != 0)
+    {
+        if (errno != EINTR)
+            return -1;
+    }
+    pthread_mutex_lock(&q->mutex);
+    *out = take_c(q);
+    pthread_mutex_unlock(&q->mutex);
+    return 0;
+}
+
+
+int dequeue_c_many(Queue_C *q, Item *out, int max)
+{
+    if (max <= 0)
+        return 0;
+
+    // Wait for one item, then reserve the other ready ones without waiting.
+    coro_sem_wait(&q->full);
+    int count = 1;
+    while (count < max && sem_trywait(&q->full) == 0)
+        count++;
+
+    pthread_mutex_lock(&q->mutex);
+    for (int i = 0; i < count; i++)
+        out[i] = take_c(q);
+    pthread_mutex_unlock(&q->mutex);
+    return count;
+}
+
+
+void delete_queue_c(Queue_C *q)
+{
+    Segment *lists[2] = {q->first, q->spare};
+    for (int i = 0; i < 2; i++)
+    {
+        Segment *seg = lists[i];
+        while (seg != NULL)
+        {
+            Segment *next = seg->next;
+            free(seg);
+            seg = next;
+        }
+    }
+    sem_destroy(&q->full);
+    pthread_mutex_destroy(&q->mutex);
+    free(q);
+}
@@ -0,0 +1,140 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_QUEUE_C_H
+#define EX3_QUEUE_C_H
+
+#include "News.h"
+#include <semaphore.h>
+#include <pthread.h>
+
+#define SEGMENT_SIZE 256
+#define SPARE_SEGMENTS 4
+
+
+/*
+ * Segment - Fixed-size array of news items, segments are linked into a queue.
+ */
+typedef struct Segment
+{
+    struct Segment *next;
+    Item news[SEGMENT_SIZE];
+} Segment;
+
+
+/*
+ * Unbounded Segmented Queue Structure:
+ *  - Items are stored in segments of SEGMENT_SIZE slots. The queue writes at 'last_index' of the 'last'
+ *    segment and reads at 'first_index' of the 'first' segment, so consecutive items are contiguous in memory.
+ *  - A drained segment is kept in 'spare' (up to SPARE_SEGMENTS of them) and reused when the queue grows again.
+ *  - Same synchronization as Queue_U: a mutex and a semaphore ('full') counting the items.
+ */
+typedef struct
+{
+    Segment *first;
+    int first_index;
+    Segment *last;
+    int last_index;
+    Segment *spare;
+    int n_spare;
+    pthread_mutex_t mutex;
+    sem_t full;
+} Queue_C;
+
+
+/*
+ * create_queue_c - Create an Unbounded Segmented Queue
+ *
+ * Return:
+ *   Queue_C* - Pointer to the newly created queue.
+ */
+Queue_C *create_queue_c();
+
+
+/*
+ * enqueue_c_mut - Enqueue a News item with Mutex Synchronization.
+ *
+ * Parameters:
+ *   Queue_C* q - Pointer to the queue.
+ *   Item news - The news item to be enqueued.
+ */
+void enqueue_c_mut(Queue_C *q, Item news);
+
+
+/*
+ * enqueue_c_many - Enqueue several News items with a single lock acquisition.
+ *
+ * Parameters:
+ *   Queue_C* q - Pointer to the queue.
+ *   Item* news - News items to be enqueued, in order.
+ *   int n - Number of news items.
+ */
+void enqueue_c_many(Queue_C *q, Item *news, int n);
+
+
+/*
+ * dequeue_c_mut - Dequeue a News item, waiting while the queue is empty.
+ *
+ * Parameters:
+ *   Queue_C* q - Pointer to the queue.
+ *
+ * Return:
+ *   Item - The news item dequeued from the queue.
+ */
+Item dequeue_c_mut(Queue_C *q);
+
+
+/*
+ * try_dequeue_c_mut - Dequeue a News item without waiting.
+ *
+ * Parameters:
+ *   Queue_C* q - Pointer to the queue.
+ *   Item* out - Receives the news item.
+ *
+ * Return:
+ *   int - 0 on success, -1 if the queue is empty.
+ */
+int try_dequeue_c_mut(Queue_C *q, Item *out);
+
+
+/*
+ * dequeue_c_until - Like dequeue_c_mut, but gives up at the deadline.
+ *
+ * Parameters:
+ *   Queue_C* q - Pointer to the queue.
+ *   Item* out - Receives the news item.
+ *   const struct timespec* deadline - Absolute CLOCK_REALTIME time.
+ *
+ * Return:
+ *   int - 0 on success, -1 if the queue stayed empty until the deadline.
+ */
+int dequeue_c_until(Queue_C *q, Item *out, const struct timespec *deadline);
+
+
+/*
+ * dequeue_c_many - Dequeue several News items with a single lock acquisition.
+ * Waits until at least one item is in the queue, then takes as many as there are, up to max.
+ *
+ * Parameters:
+ *   Queue_C* q - Pointer to the queue.
+ *   Item* out - Array that receives the news items, in order.
+ *   int max - Size of 'out'.
+ *
+ * Return:
+ *   int - Number of news items dequeued, at least 1.
+ */
+int dequeue_c_many(Queue_C *q, Item *out, int max);
+
+
+/*
+ * delete_queue_c - Delete a segmented queue. Items still in the queue are not freed.
+ *
+ * Parameters:
+ *   Queue_C* q - Pointer to the queue.
+ */
+void delete_queue_c(Queue_C *q);
+
+
+#endif //EX3_QUEUE_C_H
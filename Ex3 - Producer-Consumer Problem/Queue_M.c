@@ -0,0 +1,128 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Queue_M.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+
+Queue_M *create_queue_m(int size)
+{
+    // Round the capacity up to a power of two. One slot cannot tell "full" from "free for the next lap".
+    size_t capacity = 2;
+    while (capacity < (size_t)size)
+        capacity <<= 1;
+
+    Queue_M *q = (Queue_M *)aligned_alloc(CACHE_LINE, sizeof(Queue_M));
+    Cell *cells = (Cell *)malloc(sizeof(Cell) * capacity);
+    if (q == NULL || cells == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+
+    // Slot i is free for index i.
+    for (size_t i = 0; i < capacity; i++)
+    {
+        atomic_init(&cells[i].seq, i);
+    }
+    q->head = 0;
+    atomic_init(&q->tail, 0);
+    event_init(&q->not_empty);
+    event_init(&q->not_full);
+    q->mask = capacity - 1;
+    q->cells = cells;
+    return q;
+}
+
+
+int try_enqueue_m(Queue_M *q, Item n)
+{
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    Cell *cell;
+
+    // Claim a free slot.
+    while (1)
+    {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+            return -1;      // The slot still holds the item of the previous lap: full.
+        else
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    }
+
+    // Fill the slot and hand it to the consumer.
+    cell->news = n;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    event_signal(&q->not_empty);
+    return 0;
+}
+
+
+int enqueue_m(Queue_M *q, Item n)
+{
+    while (try_enqueue_m(q, n) != 0)
+    {
+        unsigned key = event_prepare(&q->not_full);
+        if (try_enqueue_m(q, n) == 0)
+        {
+            event_cancel(&q->not_full);
+            break;
+        }
+        event_wait(&q->not_full, key);
+    }
+    return 0;
+}
+
+
+int try_dequeue_m(Queue_M *q, Item *out)
+{
+    Cell *cell = &q->cells[q->head & q->mask];
+
+    // Not published yet: empty, or a producer is still writing it.
+    if (atomic_load_explicit(&cell->seq, memory_order_acquire) != q->head + 1)
+        return -1;
+
+    // Read the slot and make it free for the next lap.
+    *out = cell->news;
+    atomic_store_explicit(&cell->seq, q->head + q->mask + 1, memory_order_release);
+    q->head++;
+    event_signal(&q->not_full);
+    return 0;
+}
+
+
+Item dequeue_m(Queue_M *q)
+{
+    Item n;
+    while (try_dequeue_m(q, &n) != 0)
+    {
+        unsigned key = event_prepare(&q->not_empty);
+        if (try_dequeue_m(q, &n) == 0)
+        {
+            event_cancel(&q->not_empty);
+            break;
+        }
+        event_wait(&q->not_empty, key);
+    }
+    return n;
+}
+
+
+void delete_queue_m(Queue_M *q)
+{
+    free(q->cells);
+    free(q);
+}
@@ -0,0 +1,133 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_QUEUE_M_H
+#define EX3_QUEUE_M_H
+
+#include "News.h"
+#include "Event.h"
+#include "Queue_S.h"
+#include <stddef.h>
+#include <stdatomic.h>
+
+
+/*
+ * Struct: Cell
+ * Description: Slot of a Queue_M.
+ *
+ * 'seq' tells the state of the slot for the lap of the index 'pos' that maps to it:
+ *  - seq == pos: free, a producer may claim it
+ *  - seq == pos + 1: holds a news item, the consumer may read it
+ */
+typedef struct
+{
+    atomic_size_t seq;
+    Item news;
+} Cell;
+
+
+/*
+ * Struct: Queue_M
+ * Description: Bounded lock-free queue for many producer threads and one consumer thread
+ * (sequence-numbered slots, after Dmitry Vyukov's bounded queue).
+ *
+ * Producers claim a slot with a compare-and-swap on 'tail' and publish it through the slot's sequence number,
+ * so they never wait for each other. The consumer owns 'head'.
+ * Blocking operations sleep on 'not_empty' / 'not_full' and cost nothing when nobody sleeps.
+ *
+ * Members:
+ *  - head: Index of the next slot to read, consumer only
+ *  - not_full: Signalled by the consumer after it frees a slot
+ *  - tail: Index of the next slot to claim, shared by the producers
+ *  - not_empty: Signalled by a producer after it publishes a slot
+ *  - mask: Capacity - 1, the capacity is a power of two
+ *  - cells: Array of slots
+ */
+typedef struct
+{
+    _Alignas(CACHE_LINE) size_t head;
+    Event not_full;
+
+    _Alignas(CACHE_LINE) atomic_size_t tail;
+    Event not_empty;
+
+    _Alignas(CACHE_LINE) size_t mask;
+    Cell *cells;
+} Queue_M;
+
+
+/*
+ * create_queue_m - Create a new MPSC queue.
+ *
+ * Parameters:
+ *  int size - Minimum capacity of the queue, rounded up to a power of two (at least 2).
+ *
+ * Return:
+ *  Queue_M* - Pointer to the newly created queue.
+ */
+Queue_M *create_queue_m(int size);
+
+
+/*
+ * try_enqueue_m - Enqueue a news item without waiting. Any thread.
+ *
+ * Parameters:
+ *  Queue_M* q - Pointer to the queue.
+ *  Item n - The news item to insert.
+ *
+ * Return:
+ *  int - 0 on success, -1 if the queue is full.
+ */
+int try_enqueue_m(Queue_M *q, Item n);
+
+
+/*
+ * enqueue_m - Enqueue a news item, sleeping while the queue is full. Any thread.
+ *
+ * Parameters:
+ *  Queue_M* q - Pointer to the queue.
+ *  Item n - The news item to insert.
+ *
+ * Return:
+ *  int - 0 on success.
+ */
+int enqueue_m(Queue_M *q, Item n);
+
+
+/*
+ * try_dequeue_m - Dequeue a news item without waiting. Consumer thread only.
+ *
+ * Parameters:
+ *  Queue_M* q - Pointer to the queue.
+ *  Item* out - Receives the dequeued news item.
+ *
+ * Return:
+ *  int - 0 on success, -1 if no item is ready.
+ */
+int try_dequeue_m(Queue_M *q, Item *out);
+
+
+/*
+ * dequeue_m - Dequeue a news item, sleeping while the queue is empty. Consumer thread only.
+ *
+ * Parameters:
+ *  Queue_M* q - Pointer to the queue.
+ *
+ * Return:
+ *  Item - The dequeued news item.
+ */
+Item dequeue_m(Queue_M *q);
+
+
+/*
+ * delete_queue_m - Delete an MPSC queue. Items still in the queue are not freed.
+ *
+ * Parameters:
+ *  Queue_M* q - Pointer to the queue to be deleted.
+ */
+void delete_queue_m(Queue_M *q);
+
+
+#endif //EX3_QUEUE_M_H
@@ -0,0 +1,145 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Queue_P.h"
+#include "Coro.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+Queue_P *create_queue_p(int size)
+{
+    // Round the array up to a power of two, the semaphore keeps the requested bound.
+    size_t capacity = 1;
+    while (capacity < (size_t)size)
+        capacity <<= 1;
+
+    Queue_P *q = (Queue_P *)aligned_alloc(CACHE_LINE, sizeof(Queue_P));
+    Item *news = (Item *)malloc(sizeof(Item) * capacity);
+    if (q == NULL || news == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+
+    q->tail = 0;
+    q->head = 0;
+    q->mask = capacity - 1;
+    q->news = news;
+    // First touch, as in create_queue_b
+    memset(news, 0, sizeof(Item) * capacity);
+    pthread_mutex_init(&q->put_mutex, NULL);
+    pthread_mutex_init(&q->get_mutex, NULL);
+    sem_init(&q->empty, 0, size);
+    sem_init(&q->full, 0, 0);
+    return q;
+}
+
+
+/*
+ * put_p - Write 'count' items into slots reserved on 'empty', under the producer lock.
+ */
+static void put_p(Queue_P *q, Item *items, int count)
+{
+    pthread_mutex_lock(&q->put_mutex);
+    for (int i = 0; i < count; i++)
+        q->news[q->tail++ & q->mask] = items[i];
+    pthread_mutex_unlock(&q->put_mutex);
+    for (int i = 0; i < count; i++)
+        coro_sem_post(&q->full);
+}
+
+
+/*
+ * take_p - Read 'count' items reserved on 'full', under the consumer lock.
+ */
+static int take_p(Queue_P *q, Item *out, int count)
+{
+    pthread_mutex_lock(&q->get_mutex);
+    for (int i = 0; i < count; i++)
+        out[i] = q->news[q->head++ & q->mask];
+    pthread_mutex_unlock(&q->get_mutex);
+    for (int i = 0; i < count; i++)
+        coro_sem_post(&q->empty);
+    return count;
+}
+
+
+void enqueue_p(Queue_P *q, Item n)
+{
+    coro_sem_wait(&q->empty);
+    put_p(q, &n, 1);
+}
+
+
+int enqueue_p_many(Queue_P *q, Item *items, int n)
+{
+    if (n <= 0)
+        return 0;
+
+    // Wait for one free slot, then reserve the other free ones without waiting.
+    coro_sem_wait(&q->empty);
+    int count = 1;
+    while (count < n && sem_trywait(&q->empty) == 0)
+        count++;
+    put_p(q, items, count);
+    return count;
+}
+
+
+Item dequeue_p(Queue_P *q)
+{
+    Item n;
+    coro_sem_wait(&q->full);
+    take_p(q, &n, 1);
+    return n;
+}
+
+
+int try_dequeue_p(Queue_P *q, Item *out)
+{
+    if (sem_trywait(&q->full) != 0)
+        return -1;
+    take_p(q, out, 1);
+    return 0;
+}
+
+
+int dequeue_p_many(Queue_P *q, Item *out, int max)
+{
+    if (max <= 0)
+        return 0;
+
+    // Wait for one item, then reserve the other ready ones without waiting.
+    coro_sem_wait(&q->full);
+    int count = 1;
+    while (count < max && sem_trywait(&q->full) == 0)
+        count++;
+    return take_p(q, out, count);
+}
+
+
+int try_dequeue_p_many(Queue_P *q, Item *out, int max)
+{
+    if (max <= 0 || sem_trywait(&q->full) != 0)
+        return 0;
+    int count = 1;
+    while (count < max && sem_trywait(&q->full) == 0)
+        count++;
+    return take_p(q, out, count);
+}
+
+
+void delete_queue_p(Queue_P *q)
+{
+    sem_destroy(&q->full);
+    sem_destroy(&q->empty);
+    pthread_mutex_destroy(&q->put_mutex);
+    pthread_mutex_destroy(&q->get_mutex);
+    free(q->news);
+    free(q);
+}
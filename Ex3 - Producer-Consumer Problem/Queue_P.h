@@ -0,0 +1,147 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_QUEUE_P_H
+#define EX3_QUEUE_P_H
+
+#include "News.h"
+#include <stddef.h>
+#include <semaphore.h>
+#include <pthread.h>
+
+
+/*
+ * Struct: Queue_P
+ * Description: Bounded queue with the same semantics as Queue_B, laid out for several cores.
+ *
+ * The producer side and the consumer side each have their own mutex and index, on their own cache line,
+ * so a producer and a consumer never take the same lock or write the same line except for the semaphores.
+ * The semaphores already keep them on different slots: 'empty' starts at the requested size.
+ * The array is rounded up to a power of two and the indices only grow, so a slot is 'index & mask'
+ * and no NULL slot is needed to tell an empty queue from a full one.
+ *
+ * Members:
+ *  - tail, put_mutex: Index of the next slot to write and the lock of the producers
+ *  - empty: Semaphore representing the number of empty slots, waited on by the producers
+ *  - head, get_mutex: Index of the next slot to read and the lock of the consumers
+ *  - full: Semaphore representing the number of filled slots, waited on by the consumers
+ *  - mask: Size of the array - 1
+ *  - news: Array of news items (see Item)
+ */
+typedef struct
+{
+    _Alignas(CACHE_LINE) size_t tail;
+    pthread_mutex_t put_mutex;
+    sem_t empty;
+
+    _Alignas(CACHE_LINE) size_t head;
+    pthread_mutex_t get_mutex;
+    sem_t full;
+
+    _Alignas(CACHE_LINE) size_t mask;
+    Item *news;
+} Queue_P;
+
+
+/*
+ * create_queue_p - Create a padded bounded queue.
+ *
+ * Parameters:
+ *  int size - The maximum number of items in the queue.
+ *
+ * Return:
+ *  Queue_P* - Pointer to the newly created queue.
+ */
+Queue_P *create_queue_p(int size);
+
+
+/*
+ * enqueue_p - Enqueue a news item, waiting while the queue is full.
+ *
+ * Parameters:
+ *  Queue_P* q - Pointer to the queue.
+ *  Item n - The news item to insert.
+ */
+void enqueue_p(Queue_P *q, Item n);
+
+
+/*
+ * enqueue_p_many - Enqueue up to n news items with a single lock acquisition.
+ * Waits for one free slot, then takes as many free slots as there are.
+ *
+ * Parameters:
+ *  Queue_P* q - Pointer to the queue.
+ *  Item* items - News items to insert, in order.
+ *  int n - Number of news items.
+ *
+ * Return:
+ *  int - Number of news items enqueued, at least 1 if n > 0.
+ */
+int enqueue_p_many(Queue_P *q, Item *items, int n);
+
+
+/*
+ * dequeue_p - Dequeue a news item, waiting while the queue is empty.
+ *
+ * Parameters:
+ *  Queue_P* q - Pointer to the queue.
+ *
+ * Return:
+ *  Item - The dequeued news item.
+ */
+Item dequeue_p(Queue_P *q);
+
+
+/*
+ * try_dequeue_p - Dequeue a news item without waiting.
+ *
+ * Parameters:
+ *  Queue_P* q - Pointer to the queue.
+ *  Item* out - Receives the dequeued news item.
+ *
+ * Return:
+ *  int - 0 on success, -1 if the queue is empty.
+ */
+int try_dequeue_p(Queue_P *q, Item *out);
+
+
+/*
+ * dequeue_p_many - Dequeue up to max news items with a single lock acquisition, waiting while the queue is empty.
+ *
+ * Parameters:
+ *  Queue_P* q - Pointer to the queue.
+ *  Item* out - Array that receives the news items, in order.
+ *  int max - Size of 'out'.
+ *
+ * Return:
+ *  int - Number of news items dequeued, at least 1.
+ */
+int dequeue_p_many(Queue_P *q, Item *out, int max);
+
+
+/*
+ * try_dequeue_p_many - Dequeue up to max news items without waiting.
+ *
+ * Parameters:
+ *  Queue_P* q - Pointer to the queue.
+ *  Item* out - Array that receives the news items, in order.
+ *  int max - Size of 'out'.
+ *
+ * Return:
+ *  int - Number of news items dequeued, 0 if the queue is empty.
+ */
+int try_dequeue_p_many(Queue_P *q, Item *out, int max);
+
+
+/*
+ * delete_queue_p - Delete a padded bounded queue. Items still in the queue are not freed.
+ *
+ * Parameters:
+ *  Queue_P* q - Pointer to the queue.
+ */
+void delete_queue_p(Queue_P *q);
+
+
+#endif //EX3_QUEUE_P_H
@@ -0,0 +1,122 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Queue_S.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+Queue_S *create_queue_s(int size)
+{
+    // Round the array up to a power of two, the queue keeps the exact capacity.
+    size_t capacity = 1;
+    while (capacity < (size_t)size)
+        capacity <<= 1;
+
+    // The queue is aligned to a cache line so head and tail do not share one.
+    Queue_S *q = (Queue_S *)aligned_alloc(CACHE_LINE, sizeof(Queue_S));
+    Item *news = (Item *)malloc(sizeof(Item) * capacity);
+    if (q == NULL || news == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    q->tail_cache = 0;
+    q->head_cache = 0;
+    event_init(&q->not_full);
+    event_init(&q->not_empty);
+    q->mask = capacity - 1;
+    q->limit = size;
+    q->news = news;
+    // First touch, as in create_queue_b
+    memset(news, 0, sizeof(Item) * capacity);
+    return q;
+}
+
+
+int try_enqueue_s(Queue_S *q, Item n)
+{
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    // Looks full: refresh the cached head and check again.
+    if (tail - q->head_cache >= q->limit)
+    {
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (tail - q->head_cache >= q->limit)
+            return -1;
+    }
+
+    // Write the slot, then publish it.
+    q->news[tail & q->mask] = n;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    event_signal(&q->not_empty);
+    return 0;
+}
+
+
+int enqueue_s(Queue_S *q, Item n)
+{
+    // Sleep until the consumer frees a slot.
+    while (try_enqueue_s(q, n) != 0)
+    {
+        unsigned key = event_prepare(&q->not_full);
+        if (try_enqueue_s(q, n) == 0)
+        {
+            event_cancel(&q->not_full);
+            break;
+        }
+        event_wait(&q->not_full, key);
+    }
+    return 0;
+}
+
+
+int try_dequeue_s(Queue_S *q, Item *out)
+{
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    // Looks empty: refresh the cached tail and check again.
+    if (head == q->tail_cache)
+    {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (head == q->tail_cache)
+            return -1;
+    }
+
+    // Read the slot, then give it back to the producer.
+    *out = q->news[head & q->mask];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    event_signal(&q->not_full);
+    return 0;
+}
+
+
+Item dequeue_s(Queue_S *q)
+{
+    Item n;
+    while (try_dequeue_s(q, &n) != 0)
+    {
+        unsigned key = event_prepare(&q->not_empty);
+        if (try_dequeue_s(q, &n) == 0)
+        {
+            event_cancel(&q->not_empty);
+            break;
+        }
+        event_wait(&q->not_empty, key);
+    }
+    return n;
+}
+
+
+void delete_queue_s(Queue_S *q)
+{
+    free(q->news);
+    free(q);
+}
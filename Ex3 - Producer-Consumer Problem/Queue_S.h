@@ -0,0 +1,123 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_QUEUE_S_H
+#define EX3_QUEUE_S_H
+
+#include "News.h"
+#include "Event.h"
+#include <stddef.h>
+#include <stdatomic.h>
+
+/*
+ * Struct: Queue_S
+ * Description: Lock-free ring buffer for exactly one producer thread and one consumer thread.
+ *
+ * The array is a power of two, so an index is turned into a slot with a mask, but the queue holds
+ * at most 'limit' items, the size it was created with.
+ * 'head' and 'tail' only grow. Each side keeps a cached copy of the other side's index
+ * and reads the shared one only when the cached copy says the queue is full (producer) or empty (consumer).
+ * Blocking operations sleep on 'not_full' / 'not_empty' and cost nothing when nobody sleeps.
+ *
+ * Members:
+ *  - head: Index of the next slot to read, written by the consumer only
+ *  - tail_cache: Last value of 'tail' seen by the consumer
+ *  - not_full: Signalled by the consumer after it frees a slot
+ *  - tail: Index of the next slot to write, written by the producer only
+ *  - head_cache: Last value of 'head' seen by the producer
+ *  - not_empty: Signalled by the producer after it publishes a slot
+ *  - mask: Size of the array - 1
+ *  - limit: Capacity of the queue
+ *  - news: Array of news items (see Item)
+ */
+typedef struct
+{
+    _Alignas(CACHE_LINE) atomic_size_t head;
+    size_t tail_cache;
+    Event not_full;
+
+    _Alignas(CACHE_LINE) atomic_size_t tail;
+    size_t head_cache;
+    Event not_empty;
+
+    _Alignas(CACHE_LINE) size_t mask;
+    size_t limit;
+    Item *news;
+} Queue_S;
+
+
+/*
+ * create_queue_s - Create a new SPSC ring buffer.
+ *
+ * Parameters:
+ *  int size - Capacity of the queue, at least 1. The array behind it is rounded up to a power of two.
+ *
+ * Return:
+ *  Queue_S* - Pointer to the newly created queue.
+ */
+Queue_S *create_queue_s(int size);
+
+
+/*
+ * try_enqueue_s - Enqueue a news item without waiting. Producer side only.
+ *
+ * Parameters:
+ *  Queue_S* q - Pointer to the queue.
+ *  Item n - The news item to insert.
+ *
+ * Return:
+ *  int - 0 on success, -1 if the queue is full.
+ */
+int try_enqueue_s(Queue_S *q, Item n);
+
+
+/*
+ * enqueue_s - Enqueue a news item, waiting while the queue is full. Producer side only.
+ *
+ * Parameters:
+ *  Queue_S* q - Pointer to the queue.
+ *  Item n - The news item to insert.
+ *
+ * Return:
+ *  int - 0 on success.
+ */
+int enqueue_s(Queue_S *q, Item n);
+
+
+/*
+ * try_dequeue_s - Dequeue a news item without waiting. Consumer side only.
+ *
+ * Parameters:
+ *  Queue_S* q - Pointer to the queue.
+ *  Item* out - Receives the dequeued news item.
+ *
+ * Return:
+ *  int - 0 on success, -1 if the queue is empty.
+ */
+int try_dequeue_s(Queue_S *q, Item *out);
+
+
+/*
+ * dequeue_s - Dequeue a news item, waiting while the queue is empty. Consumer side only.
+ *
+ * Parameters:
+ *  Queue_S* q - Pointer to the queue.
+ *
+ * Return:
+ *  Item - The dequeued news item.
+ */
+Item dequeue_s(Queue_S *q);
+
+
+/*
+ * delete_queue_s - Delete an SPSC ring buffer. Items still in the queue are not freed.
+ *
+ * Parameters:
+ *  Queue_S* q - Pointer to the queue to be deleted.
+ */
+void delete_queue_s(Queue_S *q);
+
+
+#endif //EX3_QUEUE_S_H
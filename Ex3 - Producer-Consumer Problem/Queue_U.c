@@ -5,8 +5,10 @@
 
 
 #include "Queue_U.h"
+#include "Coro.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
 
 
 Queue_U* create_queue_u(){
@@ -17,6 +19,7 @@ Queue_U* create_queue_u(){
     }
     q->first = NULL;
     q->last = NULL;
+    q->free_nodes = NULL;
     pthread_mutex_init(&q->mutex, NULL);    // Initialize mutex and semarphore
     sem_init(&q->full, 0, 0);
     return q;
@@ -25,7 +28,7 @@ Queue_U* create_queue_u(){
 
 Node* create_node_by_value(int pr, int ind, int cat){
     // Create a News and Node structure.
-    News* n = create_new(pr, ind,cat);
+    Item n = make_item(pr, ind,cat);
     Node* node = (Node*)malloc(sizeof(Node));
     if (node == NULL){
         printf("Error! Memory allocating\n");
@@ -37,7 +40,7 @@ Node* create_node_by_value(int pr, int ind, int cat){
 }
 
 
-Node* create_node_by_new(News* news){
+Node* create_node_by_new(Item news){
 
     Node* node = (Node*)malloc(sizeof(Node));
     if (node == NULL){
@@ -54,7 +57,7 @@ void enqueue_u_mut(Queue_U* queue, Node* node){
     pthread_mutex_lock(&queue->mutex);
     enqueue_u(queue, node);
     pthread_mutex_unlock(&queue->mutex);
-    sem_post(&queue->full);     // Increase semarphore value
+    coro_sem_post(&queue->full);     // Increase semarphore value
 }
 
 void enqueue_u(Queue_U* queue, Node* node){
@@ -71,23 +74,118 @@ void enqueue_u(Queue_U* queue, Node* node){
 }
 
 
-News* dequeue_u_mut(Queue_U* queue){
+Item dequeue_u_mut(Queue_U* queue){
+    Item news = {0};      // Always set: the semaphore guarantees an item
 
     // Decrease semarphore and lock mutex
-    sem_wait(&queue->full);
+    coro_sem_wait(&queue->full);
     pthread_mutex_lock(&queue->mutex);
-    News* news = dequeue_u(queue);
+    dequeue_u(queue, &news);
     pthread_mutex_unlock(&queue->mutex);
     return news;
 }
 
 
-News* dequeue_u(Queue_U* queue){
+void enqueue_u_many(Queue_U* queue, Node** nodes, int n){
+    if (n <= 0)
+        return;
+
+    // Link the nodes to each other first, then append the whole chain under the lock.
+    for (int i = 0; i < n - 1; i++)
+        nodes[i]->next = nodes[i + 1];
+    nodes[n - 1]->next = NULL;
+
+    pthread_mutex_lock(&queue->mutex);
+    if (queue->first == NULL)
+        queue->first = nodes[0];
+    else
+        queue->last->next = nodes[0];
+    queue->last = nodes[n - 1];
+    pthread_mutex_unlock(&queue->mutex);
+    for (int i = 0; i < n; i++)
+        coro_sem_post(&queue->full);
+}
+
+
+/*
+ * take_node - Take a node from the queue's free nodes, or allocate one. Called with the mutex held.
+ */
+static Node* take_node(Queue_U* queue, Item news){
+    Node* node = queue->free_nodes;
+    if (node == NULL)
+        return create_node_by_new(news);
+    queue->free_nodes = node->next;
+    node->News = news;
+    node->next = NULL;
+    return node;
+}
+
+
+void enqueue_u_news(Queue_U* queue, Item news){
+    pthread_mutex_lock(&queue->mutex);
+    enqueue_u(queue, take_node(queue, news));
+    pthread_mutex_unlock(&queue->mutex);
+    coro_sem_post(&queue->full);
+}
+
+
+void enqueue_u_news_many(Queue_U* queue, Item* news, int n){
+    if (n <= 0)
+        return;
+    pthread_mutex_lock(&queue->mutex);
+    for (int i = 0; i < n; i++)
+        enqueue_u(queue, take_node(queue, news[i]));
+    pthread_mutex_unlock(&queue->mutex);
+    for (int i = 0; i < n; i++)
+        coro_sem_post(&queue->full);
+}
+
+
+int dequeue_u_many(Queue_U* queue, Item* out, int max){
+    if (max <= 0)
+        return 0;
+
+    // Wait for one item, then reserve the other ready ones without waiting.
+    coro_sem_wait(&queue->full);
+    int count = 1;
+    while (count < max && sem_trywait(&queue->full) == 0)
+        count++;
+
+    pthread_mutex_lock(&queue->mutex);
+    for (int i = 0; i < count; i++)
+        dequeue_u(queue, &out[i]);
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
+
+
+int try_dequeue_u_mut(Queue_U* queue, Item* out){
+    if (sem_trywait(&queue->full) != 0)
+        return -1;
+    pthread_mutex_lock(&queue->mutex);
+    dequeue_u(queue, out);
+    pthread_mutex_unlock(&queue->mutex);
+    return 0;
+}
+
+
+int dequeue_u_until(Queue_U* queue, Item* out, const struct timespec* deadline){
+    while (coro_sem_timedwait(&queue->full, deadline) != 0){
+        if (errno != EINTR)
+            return -1;
+    }
+    pthread_mutex_lock(&queue->mutex);
+    dequeue_u(queue, out);
+    pthread_mutex_unlock(&queue->mutex);
+    return 0;
+}
+
+
+int dequeue_u(Queue_U* queue, Item* out){
     Node* node;
-    News* news;
     // If queue is empty
     if (queue->first == NULL){
-        return NULL;
+        return -1;
     }
 
     // If queue has one element
@@ -95,23 +193,31 @@ News* dequeue_u(Queue_U* queue){
         node = queue->first;
         queue->first = NULL;
         queue->last = NULL;
-        news = node->News;
-        free(node);
-        return news;
     }
     // General case
-    node = queue->first;
-    queue->first = node->next;
-    news = node->News;
-    free(node);
-    return news;
+    else {
+        node = queue->first;
+        queue->first = node->next;
+    }
+
+    // Keep the node for the next enqueue
+    *out = node->News;
+    node->next = queue->free_nodes;
+    queue->free_nodes = node;
+    return 0;
 }
 
 
 void delete_queue_u(Queue_U* q){
     Node* curr = q->first;
 
-    // Free every element in queue
+    // Free every element in queue, then the free nodes
+    while (curr != NULL) {
+        Node* temp = curr;
+        curr = curr->next;
+        free(temp);
+    }
+    curr = q->free_nodes;
     while (curr != NULL) {
         Node* temp = curr;
         curr = curr->next;
@@ -16,7 +16,7 @@
  */
 typedef struct Node
 {
-    News* News;         // Pointer to a News item.
+    Item News;          // News item, or a pointer to it (see Item).
     struct Node* next;      // Pointer to the next node in the queue.
 }Node;
 
@@ -26,6 +26,8 @@ typedef struct Node
  *  - An unbounded queue consists of a linked list of nodes, where each node contains a News item.
  *  - The queue has a 'first' pointer pointing to the first node and a 'last' pointer pointing to the last node.
  *  - It also uses a mutex for thread safety and a semaphore ('full') for synchronization.
+ *  - Dequeued nodes are kept in 'free_nodes' and reused by enqueue_u_news, so a queue that reached its
+ *    largest size allocates nothing more.
  */
 typedef struct
 {
@@ -33,6 +35,7 @@ typedef struct
     Node* last;
     pthread_mutex_t mutex;
     sem_t full;
+    Node* free_nodes;
 
 }Queue_U;
 
@@ -85,15 +88,16 @@ void enqueue_u_mut(Queue_U* queue, Node* node);
 
 /*
  * dequeue_u - Dequeue a Node from an Unbounded Queue
+ * The node is kept in the queue's free nodes.
  *
  * Parameters:
  *   Queue_U* queue - Pointer to the unbounded queue.
+ *   Item* out - Receives the news item dequeued from the queue.
  *
  * Return:
- *   News* - Pointer to the news item dequeued from the queue.
- *           Returns NULL if the queue is empty.
+ *   int - 0 on success, -1 if the queue is empty.
  */
-News* dequeue_u(Queue_U* queue);
+int dequeue_u(Queue_U* queue, Item* out);
 
 
 /*
@@ -106,25 +110,99 @@ News* dequeue_u(Queue_U* queue);
  *   Queue_U* queue - Pointer to the unbounded queue.
  *
  * Return:
- *   News* - Pointer to the news item dequeued from the queue.
- *           Returns NULL if the queue is empty.
+ *   Item - The news item dequeued from the queue.
  */
-News* dequeue_u_mut(Queue_U* queue);
+Item dequeue_u_mut(Queue_U* queue);
 
 
 
 /*
- * create_node_by_new - Create a Node with a Given News Pointer
- * This function allocates memory for a new node and initializes it with the provided 'News' pointer.
+ * dequeue_u_until - Like dequeue_u_mut, but gives up at the deadline.
  *
  * Parameters:
- *   News* news - Pointer to the 'News' item to be stored in the new node.
+ *   Queue_U* queue - Pointer to the unbounded queue.
+ *   Item* out - Receives the news item.
+ *   const struct timespec* deadline - Absolute CLOCK_REALTIME time.
+ *
+ * Return:
+ *   int - 0 on success, -1 if the queue stayed empty until the deadline.
+ */
+int dequeue_u_until(Queue_U* queue, Item* out, const struct timespec* deadline);
+
+
+
+/*
+ * enqueue_u_many - Enqueue several Nodes with a single lock acquisition.
+ *
+ * Parameters:
+ *   Queue_U* queue - Pointer to the unbounded queue.
+ *   Node** nodes - Nodes to be enqueued, in order.
+ *   int n - Number of nodes.
+ */
+void enqueue_u_many(Queue_U* queue, Node** nodes, int n);
+
+
+/*
+ * enqueue_u_news - Enqueue a News item with Mutex Synchronization, in a node taken from the queue's free nodes.
+ *
+ * Parameters:
+ *   Queue_U* queue - Pointer to the unbounded queue.
+ *   Item news - The news item to be enqueued.
+ */
+void enqueue_u_news(Queue_U* queue, Item news);
+
+
+/*
+ * enqueue_u_news_many - Enqueue several News items with a single lock acquisition, in nodes taken from the queue's free nodes.
+ *
+ * Parameters:
+ *   Queue_U* queue - Pointer to the unbounded queue.
+ *   Item* news - News items to be enqueued, in order.
+ *   int n - Number of news items.
+ */
+void enqueue_u_news_many(Queue_U* queue, Item* news, int n);
+
+
+/*
+ * dequeue_u_many - Dequeue several News items with a single lock acquisition.
+ * Waits until at least one item is in the queue, then takes as many as there are, up to max.
+ *
+ * Parameters:
+ *   Queue_U* queue - Pointer to the unbounded queue.
+ *   Item* out - Array that receives the news items, in order.
+ *   int max - Size of 'out'.
+ *
+ * Return:
+ *   int - Number of news items dequeued, at least 1.
+ */
+int dequeue_u_many(Queue_U* queue, Item* out, int max);
+
+
+/*
+ * try_dequeue_u_mut - Dequeue a News item without waiting.
+ *
+ * Parameters:
+ *   Queue_U* queue - Pointer to the unbounded queue.
+ *   Item* out - Receives the news item.
+ *
+ * Return:
+ *   int - 0 on success, -1 if the queue is empty.
+ */
+int try_dequeue_u_mut(Queue_U* queue, Item* out);
+
+
+/*
+ * create_node_by_new - Create a Node with a Given News Item
+ * This function allocates memory for a new node and initializes it with the provided 'News' item.
+ *
+ * Parameters:
+ *   Item news - The 'News' item to be stored in the new node.
  *
  * Return:
  *   Node* - Pointer to the newly created node with the provided 'News' item.
  *           Returns NULL if memory allocation fails.
  */
-Node* create_node_by_new(News* news);
+Node* create_node_by_new(Item news);
 
 
 /*
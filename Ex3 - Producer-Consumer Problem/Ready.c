@@ -0,0 +1,88 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Ready.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+Ready_Set *create_ready_set(int n)
+{
+    int words = (n + READY_BITS - 1) / READY_BITS;
+    Ready_Set *r = (Ready_Set *)malloc(sizeof(Ready_Set));
+    atomic_ulong *bits = (atomic_ulong *)malloc(sizeof(atomic_ulong) * (words > 0 ? words : 1));
+    if (r == NULL || bits == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    for (int i = 0; i < words; i++)
+        atomic_init(&bits[i], 0);
+    event_init(&r->event);
+    r->n = n;
+    r->bits = bits;
+    return r;
+}
+
+
+void ready_mark(Ready_Set *r, int id)
+{
+    atomic_ulong *word = &r->bits[id / READY_BITS];
+    unsigned long bit = 1UL << (id % READY_BITS);
+
+    // Already marked and not collected yet: the consumer will see the new item anyway.
+    // The fence orders the item before this check, pairs with the fence in take_bits.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(word, memory_order_relaxed) & bit)
+        return;
+    atomic_fetch_or_explicit(word, bit, memory_order_release);
+    event_signal(&r->event);
+}
+
+
+/*
+ * take_bits - Move the set bits into 'pending'.
+ *
+ * Return:
+ *  1 if 'pending' has a bit set, 0 otherwise.
+ */
+static int take_bits(Ready_Set *r, unsigned long *pending)
+{
+    int words = (r->n + READY_BITS - 1) / READY_BITS;
+    int any = 0;
+    for (int i = 0; i < words; i++)
+    {
+        if (atomic_load_explicit(&r->bits[i], memory_order_relaxed) != 0)
+            pending[i] |= atomic_exchange_explicit(&r->bits[i], 0, memory_order_acquire);
+        any |= pending[i] != 0;
+    }
+
+    // The queues are read after the bits were cleared, pairs with the fence in ready_mark.
+    atomic_thread_fence(memory_order_seq_cst);
+    return any;
+}
+
+
+void ready_collect(Ready_Set *r, unsigned long *pending, int wait)
+{
+    while (!take_bits(r, pending) && wait)
+    {
+        unsigned key = event_prepare(&r->event);
+        if (take_bits(r, pending))
+        {
+            event_cancel(&r->event);
+            return;
+        }
+        event_wait(&r->event, key);
+    }
+}
+
+
+void delete_ready_set(Ready_Set *r)
+{
+    free(r->bits);
+    free(r);
+}
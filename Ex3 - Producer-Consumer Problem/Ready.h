@@ -0,0 +1,79 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_READY_H
+#define EX3_READY_H
+
+#include "Event.h"
+#include <stdatomic.h>
+
+#define READY_BITS (8 * (int)sizeof(unsigned long))
+
+
+/*
+ * Struct: Ready_Set
+ * Description: Lets one consumer sleep until any of N queues has data.
+ *
+ * Every producer sets the bit of its queue after it publishes an item and signals the event.
+ * The consumer takes all set bits at once and only visits the queues they name.
+ * A bit is set after the item it announces, so a consumer that clears its copy of a bit
+ * after finding the queue empty never misses a later item.
+ *
+ * Members:
+ *  - event: Signalled after a bit is set
+ *  - n: Number of queues
+ *  - bits: Readiness bitmap, one bit per queue
+ */
+typedef struct
+{
+    Event event;
+    int n;
+    atomic_ulong *bits;
+} Ready_Set;
+
+
+/*
+ * create_ready_set - Create a readiness set for n queues.
+ *
+ * Parameters:
+ *  int n - Number of queues.
+ *
+ * Return:
+ *  Ready_Set* - Pointer to the new set.
+ */
+Ready_Set *create_ready_set(int n);
+
+
+/*
+ * ready_mark - Mark a queue as ready and wake the consumer. Called by producers after they enqueue.
+ *
+ * Parameters:
+ *  Ready_Set* r - Pointer to the set.
+ *  int id - Index of the queue.
+ */
+void ready_mark(Ready_Set *r, int id);
+
+
+/*
+ * ready_collect - Move the ready bits into the consumer's own bitmap.
+ *
+ * Parameters:
+ *  Ready_Set* r - Pointer to the set.
+ *  unsigned long* pending - Consumer's bitmap of (n + READY_BITS - 1) / READY_BITS words.
+ *  int wait - If 1 and no queue is ready, sleep until one is.
+ */
+void ready_collect(Ready_Set *r, unsigned long *pending, int wait);
+
+
+/*
+ * delete_ready_set - Delete a readiness set.
+ *
+ * Parameters:
+ *  Ready_Set* r - Pointer to the set.
+ */
+void delete_ready_set(Ready_Set *r);
+
+
+#endif //EX3_READY_H
@@ -0,0 +1,58 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Rng.h"
+
+
+/*
+ * splitmix64 - Step of the SplitMix64 generator, spreads a seed over the xoshiro state.
+ */
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+static inline uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+
+void rng_seed(Rng *r, uint64_t seed, uint64_t stream)
+{
+    // Mix the stream first, so nearby seeds and streams do not give overlapping states.
+    uint64_t x = seed;
+    uint64_t mix = splitmix64(&x) ^ stream;
+    x = mix;
+    for (int i = 0; i < 4; i++)
+        r->s[i] = splitmix64(&x);
+}
+
+
+uint64_t rng_next(Rng *r)
+{
+    uint64_t *s = r->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+
+uint32_t rng_below(Rng *r, uint32_t n)
+{
+    // Multiply-shift instead of a modulo, the bias is below 2^-32 for small n.
+    return (uint32_t)(((rng_next(r) >> 32) * n) >> 32);
+}
@@ -0,0 +1,63 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_RNG_H
+#define EX3_RNG_H
+
+#include <stdint.h>
+
+
+/*
+ * Struct: Rng
+ * Description: xoshiro256** pseudo-random generator. Every thread owns its generator,
+ * so there is no shared state or lock, unlike rand().
+ *
+ * Members:
+ *  - s: State, never all zero
+ */
+typedef struct
+{
+    uint64_t s[4];
+} Rng;
+
+
+/*
+ * rng_seed - Seed a generator from a master seed and a stream number.
+ * The same seed and stream always give the same sequence, different streams give independent sequences.
+ *
+ * Parameters:
+ *  Rng* r - Pointer to the generator.
+ *  uint64_t seed - Master seed.
+ *  uint64_t stream - Stream number, e.g. the producer index.
+ */
+void rng_seed(Rng *r, uint64_t seed, uint64_t stream);
+
+
+/*
+ * rng_next - Next 64 random bits.
+ *
+ * Parameters:
+ *  Rng* r - Pointer to the generator.
+ *
+ * Return:
+ *  uint64_t - Random number.
+ */
+uint64_t rng_next(Rng *r);
+
+
+/*
+ * rng_below - Random number in [0, n).
+ *
+ * Parameters:
+ *  Rng* r - Pointer to the generator.
+ *  uint32_t n - Bound, at least 1.
+ *
+ * Return:
+ *  uint32_t - Random number below n.
+ */
+uint32_t rng_below(Rng *r, uint32_t n);
+
+
+#endif //EX3_RNG_H
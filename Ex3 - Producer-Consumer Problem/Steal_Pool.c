@@ -0,0 +1,306 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Steal_Pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * lane_push - Append stories at the tail, growing the ring buffer when needed.
+ */
+static void lane_push(Lane *l, Item *news, int count)
+{
+    pthread_mutex_lock(&l->mutex);
+    if (l->count + count > l->capacity)
+    {
+        int capacity = l->capacity;
+        while (capacity < l->count + count)
+            capacity *= 2;
+        Item *items = (Item *)malloc(capacity * sizeof(Item));
+        if (items == NULL)
+        {
+            printf("Error! Memory allocating\n");
+            exit(1);
+        }
+        for (int i = 0; i < l->count; i++)
+            items[i] = l->items[(l->head + i) & (l->capacity - 1)];
+        free(l->items);
+        l->items = items;
+        l->capacity = capacity;
+        l->head = 0;
+    }
+    for (int i = 0; i < count; i++)
+        l->items[(l->head + l->count + i) & (l->capacity - 1)] = news[i];
+    l->count += count;
+    pthread_mutex_unlock(&l->mutex);
+}
+
+
+/*
+ * lane_head - Priority of the oldest story if editor 'id' may take it, -1 otherwise.
+ */
+static int lane_head(Lane *l, int id)
+{
+    int level = -1;
+    pthread_mutex_lock(&l->mutex);
+    if (l->count > 0 && (l->holder < 0 || l->holder == id))
+        level = ITEM_NEWS(l->items[l->head])->priority;
+    pthread_mutex_unlock(&l->mutex);
+    return level;
+}
+
+
+/*
+ * lane_pop - Take the oldest story into 'out' and hold the lane, if editor 'id' may take it and its priority
+ * is 'level' (any with -1). Returns -1 if nothing is taken.
+ */
+static int lane_pop(Lane *l, int id, int level, Item *out)
+{
+    int result = -1;
+    pthread_mutex_lock(&l->mutex);
+    if (l->count > 0 && (l->holder < 0 || l->holder == id)
+        && (level < 0 || ITEM_NEWS(l->items[l->head])->priority == level))
+    {
+        *out = l->items[l->head];
+        l->head = (l->head + 1) & (l->capacity - 1);
+        l->count--;
+        l->holder = id;
+        l->in_edit++;
+        result = 0;
+    }
+    pthread_mutex_unlock(&l->mutex);
+    return result;
+}
+
+
+Steal_Pool *create_steal_pool(const int *editors, int age)
+{
+    Steal_Pool *p = (Steal_Pool *)malloc(sizeof(Steal_Pool));
+    if (p == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+
+    // Editors of every category, numbered one category after the other.
+    p->n = 0;
+    for (int c = 0; c < N_CO_EDIT; c++)
+        p->n += editors[c];
+    p->category = (int *)malloc(p->n * sizeof(int));
+    p->passed = (int *)calloc(p->n, sizeof(int));
+    if (p->category == NULL || p->passed == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    for (int c = 0, e = 0; c < N_CO_EDIT; c++)
+    {
+        for (int k = 0; k < editors[c]; k++)
+            p->category[e++] = c;
+    }
+
+    for (int c = 0; c < N_CO_EDIT; c++)
+    {
+        Lane *l = &p->lanes[c];
+        pthread_mutex_init(&l->mutex, NULL);
+        l->capacity = 64;
+        l->items = (Item *)malloc(64 * sizeof(Item));
+        l->head = 0;
+        l->count = 0;
+        l->holder = -1;
+        l->in_edit = 0;
+        if (l->items == NULL)
+        {
+            printf("Error! Memory allocating\n");
+            exit(1);
+        }
+    }
+    p->age = age;
+    atomic_init(&p->done, 0);
+    event_init(&p->work);
+    return p;
+}
+
+
+void steal_pool_put_many(Steal_Pool *p, int category, Item *news, int count)
+{
+    if (count <= 0)
+        return;
+    lane_push(&p->lanes[category], news, count);
+    event_signal(&p->work);
+}
+
+
+void steal_pool_done(Steal_Pool *p)
+{
+    atomic_store(&p->done, 1);
+    event_signal(&p->work);
+}
+
+
+/*
+ * try_take_urgent - Take the most urgent story at the head of a lane the editor may take from into 'out',
+ * its own lane on a tie or once it has been passed over 'age' times. Returns -1 if there is none.
+ */
+static int try_take_urgent(Steal_Pool *p, int id, Item *out)
+{
+    int own_category = p->category[id];
+    while (1)
+    {
+        int best = -1, best_level = PRIORITY_LEVELS, own = 0;
+        for (int k = 0; k < N_CO_EDIT && best_level > 0; k++)
+        {
+            int c = (own_category + k) % N_CO_EDIT;
+            int level = lane_head(&p->lanes[c], id);
+            if (level >= 0 && level < best_level)
+            {
+                best = c;
+                best_level = level;
+            }
+
+            if (k == 0 && best == c)
+            {
+                own = 1;
+                if (p->passed[id] >= p->age)
+                    break;
+            }
+        }
+        if (best < 0)
+            return -1;
+
+        // Another editor may have taken that head or the lane since, look again then
+        if (lane_pop(&p->lanes[best], id, best_level, out) != 0)
+            continue;
+
+        if (best == own_category)
+            p->passed[id] = 0;
+        else if (own)
+            p->passed[id]++;
+        return 0;
+    }
+}
+
+
+/*
+ * try_take - Take a story from the editor's own lane, or from a lane it takes over, into 'out'.
+ * With priorities the most urgent story goes first. Returns -1 if there is nothing the editor may take.
+ */
+static int try_take(Steal_Pool *p, int id, Item *out)
+{
+    if (p->age > 0)
+        return try_take_urgent(p, id, out);
+
+    // The lane of the editor's category first, then the next ones.
+    for (int k = 0; k < N_CO_EDIT; k++)
+    {
+        if (lane_pop(&p->lanes[(p->category[id] + k) % N_CO_EDIT], id, -1, out) == 0)
+            return 0;
+    }
+    return -1;
+}
+
+
+/*
+ * lanes_empty - Check that no lane has a story left.
+ */
+static int lanes_empty(Steal_Pool *p)
+{
+    for (int c = 0; c < N_CO_EDIT; c++)
+    {
+        pthread_mutex_lock(&p->lanes[c].mutex);
+        int count = p->lanes[c].count;
+        pthread_mutex_unlock(&p->lanes[c].mutex);
+        if (count > 0)
+            return 0;
+    }
+    return 1;
+}
+
+
+/*
+ * try_take_or_done - try_take, or a "DONE" once 'done' is set and every lane is empty.
+ * An editor that only finds held lanes keeps waiting, it may take them over when they are released.
+ */
+static int try_take_or_done(Steal_Pool *p, int id, Item *out)
+{
+    // Every story was put before 'done' was set, so the lanes are read after it.
+    int done = atomic_load(&p->done);
+    if (try_take(p, id, out) == 0)
+        return 0;
+    if (!done || !lanes_empty(p))
+        return -1;
+    *out = make_item(DONE, DONE, DONE);
+    return 0;
+}
+
+
+Item steal_pool_take(Steal_Pool *p, int id)
+{
+    Item n;
+    steal_pool_take_until(p, id, &n, NULL);
+    return n;
+}
+
+
+int steal_pool_take_until(Steal_Pool *p, int id, Item *out, const struct timespec *deadline)
+{
+    while (try_take_or_done(p, id, out) != 0)
+    {
+        unsigned key = event_prepare(&p->work);
+        if (try_take_or_done(p, id, out) == 0)
+        {
+            event_cancel(&p->work);
+            break;
+        }
+        if (deadline == NULL)
+        {
+            event_wait(&p->work, key);
+            continue;
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        if (now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec))
+        {
+            event_cancel(&p->work);
+            return -1;
+        }
+        event_wait_until(&p->work, key, deadline);
+    }
+    return 0;
+}
+
+
+void steal_pool_release(Steal_Pool *p, int id, int category)
+{
+    Lane *l = &p->lanes[category];
+    int freed = 0;
+    pthread_mutex_lock(&l->mutex);
+    if (l->holder == id && --l->in_edit == 0)
+    {
+        l->holder = -1;
+        freed = 1;
+    }
+    pthread_mutex_unlock(&l->mutex);
+
+    // Another editor may take the lane over now, or finish once it is empty
+    if (freed)
+        event_signal(&p->work);
+}
+
+
+void delete_steal_pool(Steal_Pool *p)
+{
+    for (int c = 0; c < N_CO_EDIT; c++)
+    {
+        pthread_mutex_destroy(&p->lanes[c].mutex);
+        free(p->lanes[c].items);
+    }
+    free(p->category);
+    free(p->passed);
+    free(p);
+}
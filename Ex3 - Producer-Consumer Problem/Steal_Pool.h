@@ -0,0 +1,164 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_STEAL_POOL_H
+#define EX3_STEAL_POOL_H
+
+#include "News.h"
+#include "Event.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+
+/*
+ * Struct: Lane
+ * Description: Growable ring buffer of the stories of one category, in the order the dispatchers put them.
+ *
+ * The editor that takes a story holds the lane until it has put the story into the shared queue.
+ * Only the holder takes from a held lane, so the stories of a category leave the editors in their order.
+ *
+ * Members:
+ *  - mutex: Protects the lane
+ *  - items: Ring buffer of 'capacity' slots (a power of two)
+ *  - head: Index of the oldest item
+ *  - count: Number of items
+ *  - holder: Editor that holds the lane, -1 if none
+ *  - in_edit: Stories the holder has taken and not released yet
+ */
+typedef struct
+{
+    pthread_mutex_t mutex;
+    Item *items;
+    int capacity;
+    int head;
+    int count;
+    int holder;
+    int in_edit;
+} Lane;
+
+
+/*
+ * Struct: Steal_Pool
+ * Description: Work-stealing editing stage.
+ *
+ * The dispatchers put the stories of every category into its lane. An editor takes from the lane of its own
+ * category, and when that lane is empty or held by another editor it takes over the lane of another category
+ * that is free, so a skewed mix of categories keeps every editor busy. Stealing a whole lane instead of
+ * single stories keeps the stories of every producer and category in order.
+ * An editor sleeps on 'work' only when no lane has a story it may take.
+ *
+ * With priorities, an editor takes the most urgent story at the head of the lanes it may take from,
+ * its own category's lane on a tie. Its own lane is taken anyway after 'age' takes went to more urgent ones.
+ *
+ * Shutdown: after all stories the last dispatcher sets 'done'. An editor gets a "DONE" once 'done' is set
+ * and every lane is empty. Until then an editor that only finds held lanes waits for their release.
+ *
+ * Members:
+ *  - n: Number of editors
+ *  - category: Category of every editor
+ *  - passed: Takes of every editor that went to more urgent stories while its own lane had one. That editor only.
+ *  - lanes: One lane per category
+ *  - age: Takes an editor's own lane may be passed over, 0 to take the stories without priorities
+ *  - done: Set after all stories were put
+ *  - work: Signalled after stories are added, a lane is freed or 'done' is set
+ */
+typedef struct
+{
+    int n;
+    int *category;
+    int *passed;
+    Lane lanes[N_CO_EDIT];
+    int age;
+    atomic_int done;
+    Event work;
+} Steal_Pool;
+
+
+/*
+ * create_steal_pool - Create a work-stealing pool.
+ * The editors are numbered by category: editors[0] editors of SPORT first, then NEWS, then WEATHER.
+ *
+ * Parameters:
+ *  const int* editors - Number of editors of every category, each at least 1.
+ *  int age - Takes an editor's own lane may be passed over by more urgent stories, 0 to ignore the priorities.
+ *
+ * Return:
+ *  Steal_Pool* - Pointer to the new pool.
+ */
+Steal_Pool *create_steal_pool(const int *editors, int age);
+
+
+/*
+ * steal_pool_put_many - Give stories of one category to its lane. Any dispatcher.
+ *
+ * Parameters:
+ *  Steal_Pool* p - Pointer to the pool.
+ *  int category - Category of the stories.
+ *  Item* news - Stories, in order.
+ *  int count - Number of stories.
+ */
+void steal_pool_put_many(Steal_Pool *p, int category, Item *news, int count);
+
+
+/*
+ * steal_pool_done - Let the editors finish once no story is left, after all stories. Called once, by the last dispatcher.
+ *
+ * Parameters:
+ *  Steal_Pool* p - Pointer to the pool.
+ */
+void steal_pool_done(Steal_Pool *p);
+
+
+/*
+ * steal_pool_take - Take the next story of an editor: from its own lane, or from a lane it takes over.
+ * Sleeps while there is none. The editor holds the lane of the story until steal_pool_release.
+ *
+ * Parameters:
+ *  Steal_Pool* p - Pointer to the pool.
+ *  int id - Index of the editor.
+ *
+ * Return:
+ *  Item - The story, or a "DONE" once no story is left for the editor.
+ */
+Item steal_pool_take(Steal_Pool *p, int id);
+
+
+/*
+ * steal_pool_take_until - Like steal_pool_take, but gives up at the deadline.
+ *
+ * Parameters:
+ *  Steal_Pool* p - Pointer to the pool.
+ *  int id - Index of the editor.
+ *  Item* out - Receives the story, or a "DONE".
+ *  const struct timespec* deadline - Absolute CLOCK_REALTIME time, NULL to wait without a limit.
+ *
+ * Return:
+ *  0 on success, -1 if nothing came before the deadline.
+ */
+int steal_pool_take_until(Steal_Pool *p, int id, Item *out, const struct timespec *deadline);
+
+
+/*
+ * steal_pool_release - Tell the pool that a story taken by an editor is in the shared queue.
+ * The lane is free for the other editors once every story the editor took from it is released.
+ *
+ * Parameters:
+ *  Steal_Pool* p - Pointer to the pool.
+ *  int id - Index of the editor.
+ *  int category - Category of the story.
+ */
+void steal_pool_release(Steal_Pool *p, int id, int category);
+
+
+/*
+ * delete_steal_pool - Delete a work-stealing pool.
+ *
+ * Parameters:
+ *  Steal_Pool* p - Pointer to the pool.
+ */
+void delete_steal_pool(Steal_Pool *p);
+
+
+#endif //EX3_STEAL_POOL_H
@@ -0,0 +1,409 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Telemetry.h"
+#include "Coro.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+
+
+/*
+ * Stage_Record - Counters of one thread, written by that thread only.
+ */
+typedef struct Stage_Record
+{
+    int stage;
+    atomic_ullong items;
+    atomic_ullong waits;
+    atomic_ullong blocked_ns;
+    struct Stage_Record *next;
+} Stage_Record;
+
+
+/*
+ * Queue_Group - Channels sampled together, and the depths seen so far. Used by the telemetry thread only.
+ */
+typedef struct
+{
+    const char *name;
+    Channel **channels;
+    int n;
+    long samples;
+    double depth_sum;
+    int depth_now;
+    int depth_max;
+    int queue_max;
+} Queue_Group;
+
+
+static const char *stage_names[N_STAGES] = {"producer", "dispatcher", "editor", "screen"};
+static const char *category_names[N_CO_EDIT] = {"sport", "news", "weather"};
+
+static int enabled = 0;
+static FILE *out = NULL;
+static struct timespec epoch;
+static pthread_t thread;
+static atomic_int stopping;
+
+static pthread_mutex_t records_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Stage_Record *records = NULL;
+static __thread Stage_Record *self = NULL;
+
+static Queue_Group groups[TELEMETRY_GROUPS];
+static int n_groups = 0;
+
+// End-to-end latency in microseconds by category and by priority level, written by the screen manager only.
+static atomic_ullong latency[N_CO_EDIT][HIST_BUCKETS];
+static atomic_ullong latency_max[N_CO_EDIT];
+static atomic_ullong level_latency[PRIORITY_LEVELS][HIST_BUCKETS];
+static atomic_ullong level_latency_max[PRIORITY_LEVELS];
+
+
+/*
+ * bump - Add to a counter that only the calling thread writes.
+ */
+static void bump(atomic_ullong *c, unsigned long long n)
+{
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+
+/*
+ * now_ns - Time since telemetry_start in nanoseconds.
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)(t.tv_sec - epoch.tv_sec) * 1000000000ULL + t.tv_nsec - epoch.tv_nsec;
+}
+
+
+/*
+ * record - Record of the calling thread or coroutine, NULL if it is not registered.
+ */
+static Stage_Record *record(void)
+{
+    void **local = coro_local();
+    return local != NULL ? (Stage_Record *)*local : self;
+}
+
+
+/*
+ * hist_index - Bucket of a value. Below 2 * HIST_SUB a value has its own bucket, above it the
+ * HIST_SUB buckets of every power of two keep the 4 bits after the highest one.
+ */
+static int hist_index(unsigned v)
+{
+    if (v < 2 * HIST_SUB)
+        return v;
+    int shift = 31 - __builtin_clz(v) - 4;
+    return (shift + 1) * HIST_SUB + (int)(v >> shift) - HIST_SUB;
+}
+
+
+/*
+ * hist_high - Highest value of a bucket.
+ */
+static unsigned long long hist_high(int i)
+{
+    if (i < 2 * HIST_SUB)
+        return i;
+    int shift = i / HIST_SUB - 1;
+    unsigned long long low = (unsigned long long)(i % HIST_SUB + HIST_SUB) << shift;
+    return low + (1ULL << shift) - 1;
+}
+
+
+/*
+ * sample_queues - Add the current depths of every group.
+ */
+static void sample_queues(void)
+{
+    for (int g = 0; g < n_groups; g++)
+    {
+        Queue_Group *q = &groups[g];
+        int total = 0;
+        for (int i = 0; i < q->n; i++)
+        {
+            int d = channel_depth(q->channels[i]);
+            total += d;
+            if (d > q->queue_max)
+                q->queue_max = d;
+        }
+        q->samples++;
+        q->depth_sum += total;
+        q->depth_now = total;
+        if (total > q->depth_max)
+            q->depth_max = total;
+    }
+}
+
+
+/*
+ * dump_latency - Write the count, percentiles and maximum of a histogram, as a JSON object.
+ */
+static void dump_latency(const char *name, const unsigned long long *hist, unsigned long long max)
+{
+    unsigned long long count = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+        count += hist[i];
+
+    const double percentiles[] = {0.5, 0.9, 0.99, 0.999};
+    const char *labels[] = {"p50", "p90", "p99", "p999"};
+    fprintf(out, "\"%s\":{\"count\":%llu", name, count);
+    unsigned long long seen = 0;
+    int i = 0;
+    for (int p = 0; p < 4; p++)
+    {
+        // First bucket that reaches the rank of the percentile, reported as its highest value
+        unsigned long long v = 0;
+        if (count > 0)
+        {
+            unsigned long long rank = (unsigned long long)(percentiles[p] * count);
+            if (rank == 0)
+                rank = 1;
+            while (seen + hist[i] < rank)
+                seen += hist[i++];
+            v = hist_high(i);
+        }
+        fprintf(out, ",\"%s\":%llu", labels[p], v < max ? v : max);
+    }
+    fprintf(out, ",\"max\":%llu}", max);
+}
+
+
+/*
+ * dump - Aggregate the records and write one JSON line.
+ */
+static void dump(int final)
+{
+    unsigned long long items[N_STAGES] = {0}, waits[N_STAGES] = {0}, blocked[N_STAGES] = {0};
+    int threads[N_STAGES] = {0};
+    pthread_mutex_lock(&records_mutex);
+    for (Stage_Record *r = records; r != NULL; r = r->next)
+    {
+        threads[r->stage]++;
+        items[r->stage] += atomic_load_explicit(&r->items, memory_order_relaxed);
+        waits[r->stage] += atomic_load_explicit(&r->waits, memory_order_relaxed);
+        blocked[r->stage] += atomic_load_explicit(&r->blocked_ns, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&records_mutex);
+
+    fprintf(out, "{\"time_ms\":%.3f,\"final\":%s,\"stages\":{", now_ns() / 1e6, final ? "true" : "false");
+    for (int s = 0; s < N_STAGES; s++)
+        fprintf(out, "%s\"%s\":{\"threads\":%d,\"items\":%llu,\"waits\":%llu,\"blocked_ms\":%.3f}",
+                s ? "," : "", stage_names[s], threads[s], items[s], waits[s], blocked[s] / 1e6);
+
+    fprintf(out, "},\"queues\":{");
+    for (int g = 0; g < n_groups; g++)
+    {
+        Queue_Group *q = &groups[g];
+        fprintf(out, "%s\"%s\":{\"channels\":%d,\"samples\":%ld,\"depth_now\":%d,\"depth_mean\":%.2f,"
+                     "\"depth_max\":%d,\"queue_max\":%d}",
+                g ? "," : "", q->name, q->n, q->samples, q->depth_now,
+                q->samples ? q->depth_sum / q->samples : 0.0, q->depth_max, q->queue_max);
+    }
+
+    fprintf(out, "},\"latency_us\":{");
+    unsigned long long all[HIST_BUCKETS] = {0}, all_max = 0;
+    for (int c = 0; c < N_CO_EDIT; c++)
+    {
+        unsigned long long hist[HIST_BUCKETS];
+        for (int i = 0; i < HIST_BUCKETS; i++)
+        {
+            hist[i] = atomic_load_explicit(&latency[c][i], memory_order_relaxed);
+            all[i] += hist[i];
+        }
+        unsigned long long max = atomic_load_explicit(&latency_max[c], memory_order_relaxed);
+        if (max > all_max)
+            all_max = max;
+        dump_latency(category_names[c], hist, max);
+        fprintf(out, ",");
+    }
+    dump_latency("all", all, all_max);
+
+    fprintf(out, "},\"priority_latency_us\":{");
+    for (int l = 0; l < PRIORITY_LEVELS; l++)
+    {
+        unsigned long long hist[HIST_BUCKETS];
+        for (int i = 0; i < HIST_BUCKETS; i++)
+            hist[i] = atomic_load_explicit(&level_latency[l][i], memory_order_relaxed);
+        char name[16];
+        snprintf(name, sizeof(name), "%d", l);
+        if (l > 0)
+            fprintf(out, ",");
+        dump_latency(name, hist, atomic_load_explicit(&level_latency_max[l], memory_order_relaxed));
+    }
+    fprintf(out, "}}\n");
+    fflush(out);
+}
+
+
+/*
+ * telemetry_main - Telemetry thread: samples the queues, dumps on SIGUSR1 and when stopped.
+ */
+static void *telemetry_main(void *arg)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    struct timespec period = {0, TELEMETRY_SAMPLE_MS * 1000000L};
+    (void)arg;
+
+    while (1)
+    {
+        int sig = sigtimedwait(&set, NULL, &period);
+        sample_queues();
+        if (atomic_load(&stopping))
+            break;
+        if (sig == SIGUSR1)
+            dump(0);
+    }
+    dump(1);
+    return NULL;
+}
+
+
+int telemetry_start(const char *target)
+{
+    if (strcmp(target, "off") == 0)
+        return 0;
+    if (strcmp(target, "stderr") == 0)
+        out = stderr;
+    else
+    {
+        out = fopen(target, "a");
+        if (out == NULL)
+        {
+            printf("Cannot open %s\n", target);
+            return -1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &epoch);
+    atomic_init(&stopping, 0);
+    enabled = 1;
+
+    // The threads created after this call inherit the blocked SIGUSR1, only the telemetry thread takes it
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+    if (pthread_create(&thread, NULL, &telemetry_main, NULL) != 0)
+        exit(1);
+    return 0;
+}
+
+
+void telemetry_queues(const char *name, Channel **channels, int n)
+{
+    if (n_groups == TELEMETRY_GROUPS)
+        return;
+    Queue_Group *q = &groups[n_groups++];
+    memset(q, 0, sizeof(Queue_Group));
+    q->name = name;
+    q->channels = channels;
+    q->n = n;
+}
+
+
+void telemetry_thread(int stage)
+{
+    if (!enabled)
+        return;
+    Stage_Record *r = (Stage_Record *)calloc(1, sizeof(Stage_Record));
+    if (r == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    r->stage = stage;
+    pthread_mutex_lock(&records_mutex);
+    r->next = records;
+    records = r;
+    pthread_mutex_unlock(&records_mutex);
+
+    void **local = coro_local();
+    if (local != NULL)
+        *local = r;
+    else
+        self = r;
+}
+
+
+void telemetry_items(int n)
+{
+    if (!enabled)
+        return;
+    Stage_Record *r = record();
+    if (r != NULL)
+        bump(&r->items, n);
+}
+
+
+void telemetry_stamp(News *n)
+{
+    if (enabled)
+        n->created_us = (unsigned)(now_ns() / 1000);
+}
+
+
+void telemetry_delivered(const News *n)
+{
+    if (!enabled)
+        return;
+    // Differences of the wrapping 32-bit clock stay right for 71 minutes
+    unsigned us = (unsigned)(now_ns() / 1000) - n->created_us;
+    bump(&latency[n->category][hist_index(us)], 1);
+    if (us > atomic_load_explicit(&latency_max[n->category], memory_order_relaxed))
+        atomic_store_explicit(&latency_max[n->category], us, memory_order_relaxed);
+    bump(&level_latency[n->priority][hist_index(us)], 1);
+    if (us > atomic_load_explicit(&level_latency_max[n->priority], memory_order_relaxed))
+        atomic_store_explicit(&level_latency_max[n->priority], us, memory_order_relaxed);
+}
+
+
+uint64_t telemetry_wait_begin(void)
+{
+    return enabled ? now_ns() : 0;
+}
+
+
+void telemetry_wait_end(uint64_t begin)
+{
+    if (!enabled)
+        return;
+    Stage_Record *r = record();
+    if (r == NULL)
+        return;
+    bump(&r->waits, 1);
+    bump(&r->blocked_ns, now_ns() - begin);
+}
+
+
+void telemetry_stop(void)
+{
+    if (!enabled)
+        return;
+    atomic_store(&stopping, 1);
+    pthread_kill(thread, SIGUSR1);
+    pthread_join(thread, NULL);
+    enabled = 0;
+    if (out != stderr)
+        fclose(out);
+
+    while (records != NULL)
+    {
+        Stage_Record *next = records->next;
+        free(records);
+        records = next;
+    }
+}
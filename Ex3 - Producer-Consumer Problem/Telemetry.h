@@ -0,0 +1,121 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_TELEMETRY_H
+#define EX3_TELEMETRY_H
+
+#include "Channel.h"
+#include <stdint.h>
+
+#define TELEMETRY_SAMPLE_MS 10
+#define TELEMETRY_GROUPS 4
+
+// Log-linear histogram: values below 2 * HIST_SUB exactly, then HIST_SUB buckets per power of two.
+#define HIST_SUB 16
+#define HIST_BUCKETS 464
+
+
+/*
+ * Pipeline telemetry (TELEMETRY=stderr or TELEMETRY=<file>).
+ *
+ * Every thread of the pipeline (every coroutine with RUNTIME=coroutines) registers a record of its stage
+ * with telemetry_thread and only it writes there: the number of items it handled, and the number and the
+ * total time of its waits that blocked (the slow path of coro_sem_wait, coro_sem_timedwait and Event).
+ * Producers stamp every story with its creation time, and the screen manager adds the end-to-end
+ * latency of every printed story to a log-linear histogram of its category and one of its priority level.
+ *
+ * A telemetry thread samples the depths of the registered channel groups every TELEMETRY_SAMPLE_MS,
+ * and aggregates the records only when it dumps them: on SIGUSR1 and once more at exit,
+ * one JSON object per line. SIGUSR1 is blocked in every other thread and taken with sigtimedwait,
+ * so no signal handler interrupts the waits of the queues.
+ *
+ * Without telemetry every function returns at once.
+ */
+
+
+/*
+ * telemetry_start - Start the telemetry. Call after telemetry_queues and before the threads are created.
+ *
+ * Parameters:
+ *  const char* target - "off", "stderr" or the path of a file the dumps are appended to.
+ *
+ * Return:
+ *  int - 0 on success, -1 if the file cannot be opened.
+ */
+int telemetry_start(const char *target);
+
+
+/*
+ * telemetry_queues - Register a group of channels whose depths are sampled.
+ *
+ * Parameters:
+ *  const char* name - Name of the group in the dumps.
+ *  Channel** channels - The channels.
+ *  int n - Number of channels.
+ */
+void telemetry_queues(const char *name, Channel **channels, int n);
+
+
+/*
+ * telemetry_thread - Register the calling thread, or coroutine, as a thread of a stage.
+ *
+ * Parameters:
+ *  int stage - STAGE of the thread.
+ */
+void telemetry_thread(int stage);
+
+
+/*
+ * telemetry_items - Count items handled by the calling thread.
+ *
+ * Parameters:
+ *  int n - Number of items.
+ */
+void telemetry_items(int n);
+
+
+/*
+ * telemetry_stamp - Set the creation time of a story.
+ *
+ * Parameters:
+ *  News* n - The story.
+ */
+void telemetry_stamp(News *n);
+
+
+/*
+ * telemetry_delivered - Add the end-to-end latency of a printed story to the histograms of its category and priority.
+ *
+ * Parameters:
+ *  const News* n - The story.
+ */
+void telemetry_delivered(const News *n);
+
+
+/*
+ * telemetry_wait_begin - Start timing a wait that blocks.
+ *
+ * Return:
+ *  uint64_t - Start time to pass to telemetry_wait_end, 0 without telemetry.
+ */
+uint64_t telemetry_wait_begin(void);
+
+
+/*
+ * telemetry_wait_end - Add a blocked wait to the record of the calling thread.
+ *
+ * Parameters:
+ *  uint64_t begin - Value returned by telemetry_wait_begin.
+ */
+void telemetry_wait_end(uint64_t begin);
+
+
+/*
+ * telemetry_stop - Write the final dump and stop the telemetry thread. Call after the pipeline has finished.
+ */
+void telemetry_stop(void);
+
+
+#endif //EX3_TELEMETRY_H
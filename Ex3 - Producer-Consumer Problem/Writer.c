@@ -0,0 +1,130 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+
+#include "Writer.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+Writer *create_writer(int fd, int flush_ms)
+{
+    Writer *w = (Writer *)malloc(sizeof(Writer));
+    if (w == NULL)
+    {
+        printf("Error! Memory allocating\n");
+        exit(1);
+    }
+    w->fd = fd;
+    w->len = 0;
+    w->interval_ns = flush_ms * 1000000L;
+    clock_gettime(CLOCK_MONOTONIC, &w->last);
+    return w;
+}
+
+
+/*
+ * write_out - Write the first n bytes of the buffer and keep the rest.
+ */
+static void write_out(Writer *w, int n)
+{
+    int done = 0;
+    while (done < n)
+    {
+        ssize_t r = write(w->fd, w->buf + done, n - done);
+        if (r < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            exit(1);
+        }
+        done += r;
+    }
+    memmove(w->buf, w->buf + n, w->len - n);
+    w->len -= n;
+    clock_gettime(CLOCK_MONOTONIC, &w->last);
+}
+
+
+/*
+ * complete_lines - Number of bytes of the buffer that form complete lines.
+ */
+static int complete_lines(Writer *w)
+{
+    int n = w->len;
+    while (n > 0 && w->buf[n - 1] != '\n')
+        n--;
+    return n;
+}
+
+
+void writer_str(Writer *w, const char *s, int n)
+{
+    // Only a line longer than WRITER_LINE gets here with a full buffer, it is written in pieces.
+    while (w->len + n > (int)sizeof(w->buf))
+    {
+        int part = sizeof(w->buf) - w->len;
+        memcpy(w->buf + w->len, s, part);
+        w->len += part;
+        s += part;
+        n -= part;
+        write_out(w, w->len);
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+
+void writer_int(Writer *w, int v)
+{
+    // Digits are produced backwards into a small buffer, then copied once.
+    char digits[12];
+    int i = sizeof(digits);
+    unsigned u = v < 0 ? -(unsigned)v : (unsigned)v;
+    do
+    {
+        digits[--i] = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+    if (v < 0)
+        digits[--i] = '-';
+    writer_str(w, digits + i, sizeof(digits) - i);
+}
+
+
+void writer_end_line(Writer *w)
+{
+    writer_str(w, "\n", 1);
+    if (w->len >= WRITER_BUFFER)
+        write_out(w, w->len);
+}
+
+
+void writer_tick(Writer *w)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long elapsed = (now.tv_sec - w->last.tv_sec) * 1000000000L + (now.tv_nsec - w->last.tv_nsec);
+    if (elapsed >= w->interval_ns)
+        writer_flush(w);
+}
+
+
+void writer_flush(Writer *w)
+{
+    int n = complete_lines(w);
+    if (n > 0)
+        write_out(w, n);
+}
+
+
+void delete_writer(Writer *w)
+{
+    writer_flush(w);
+    free(w);
+}
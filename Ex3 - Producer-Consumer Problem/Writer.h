@@ -0,0 +1,109 @@
+/*
+ * Author: Semyon Guretskiy
+ * Date: 25/09/2023
+ */
+
+#ifndef EX3_WRITER_H
+#define EX3_WRITER_H
+
+#include <time.h>
+
+#define WRITER_BUFFER (1 << 16)
+#define WRITER_LINE 128
+
+
+/*
+ * Struct: Writer
+ * Description: Buffered line output owned by one thread, written to a file descriptor without stdio.
+ *
+ * Lines are formatted into 'buf' and written with write(2) only as whole lines, when the buffer is full,
+ * when writer_tick finds that 'interval' has passed since the last write, or on writer_flush.
+ * The buffer keeps WRITER_LINE spare bytes, so a line never has to be split.
+ *
+ * Members:
+ *  - fd: Output file descriptor
+ *  - buf, len: Buffered bytes
+ *  - last: Time of the last write
+ *  - interval_ns: Longest time a complete line stays in the buffer while lines keep coming
+ */
+typedef struct
+{
+    int fd;
+    char buf[WRITER_BUFFER + WRITER_LINE];
+    int len;
+    struct timespec last;
+    long interval_ns;
+} Writer;
+
+
+/*
+ * create_writer - Create a writer.
+ *
+ * Parameters:
+ *  int fd - Output file descriptor.
+ *  int flush_ms - Flush interval in milliseconds.
+ *
+ * Return:
+ *  Writer* - Pointer to the new writer.
+ */
+Writer *create_writer(int fd, int flush_ms);
+
+
+/*
+ * writer_str - Append n characters to the current line.
+ *
+ * Parameters:
+ *  Writer* w - Pointer to the writer.
+ *  const char* s - Characters.
+ *  int n - Number of characters.
+ */
+void writer_str(Writer *w, const char *s, int n);
+
+
+/*
+ * writer_int - Append an integer in decimal to the current line.
+ *
+ * Parameters:
+ *  Writer* w - Pointer to the writer.
+ *  int v - The integer.
+ */
+void writer_int(Writer *w, int v);
+
+
+/*
+ * writer_end_line - End the current line, and write the buffer if it is full.
+ *
+ * Parameters:
+ *  Writer* w - Pointer to the writer.
+ */
+void writer_end_line(Writer *w);
+
+
+/*
+ * writer_tick - Write the buffer if the flush interval has passed since the last write.
+ *
+ * Parameters:
+ *  Writer* w - Pointer to the writer.
+ */
+void writer_tick(Writer *w);
+
+
+/*
+ * writer_flush - Write every complete line in the buffer.
+ *
+ * Parameters:
+ *  Writer* w - Pointer to the writer.
+ */
+void writer_flush(Writer *w);
+
+
+/*
+ * delete_writer - Flush and delete a writer. The file descriptor stays open.
+ *
+ * Parameters:
+ *  Writer* w - Pointer to the writer.
+ */
+void delete_writer(Writer *w);
+
+
+#endif //EX3_WRITER_H
@@ -0,0 +1,54 @@
+#!/bin/sh
+# Runs the pipeline with several editors per category, in both edit modes, and checks that the stories of
+# every producer and category reach the screen in the order the producer made them, with none lost.
+# Usage: ./check_order.sh [PRODUCERS] [STORIES]
+
+PRODUCERS=${1:-20}
+STORIES=${2:-300}
+BIN=./Consumer_Producer.out
+CONF=$(mktemp)
+OUT=$(mktemp)
+trap 'rm -f "$CONF" "$OUT"' EXIT
+
+# Small producer and shared queues, so the editors block and the lanes change hands often
+i=1
+while [ $i -le "$PRODUCERS" ]; do
+    printf '%d\n%d\n5\n\n' "$i" "$STORIES" >> "$CONF"
+    i=$((i + 1))
+done
+echo 5 >> "$CONF"
+
+failed=0
+while read -r settings; do
+    $BIN "$CONF" SEED=1 EDIT_MS=0 $settings > "$OUT"
+    result=$(awk -v total=$((PRODUCERS * STORIES)) '
+        $1 == "Producer" {
+            key = $2 " " $3
+            if ((key in last) && $4 != last[key] + 1)
+                bad++
+            last[key] = $4
+            count++
+        }
+        END {
+            if (bad > 0 || count != total || $0 != "DONE")
+                printf "FAIL: %d stories of %d, %d out of order", count, total, bad
+            else
+                printf "ok"
+        }' "$OUT")
+    echo "$settings: $result"
+    case $result in
+        ok) ;;
+        *) failed=1 ;;
+    esac
+done <<EOF
+EDIT_MODE=category EDITORS=3
+EDIT_MODE=category EDITORS=3 EDITING=timer EDIT_MS=1
+EDIT_MODE=category EDITORS=2 SPORT_EDITORS=4 DISPATCHERS=3 EDITOR_QUEUE=chunked
+EDIT_MODE=category EDITORS=3 RUNTIME=coroutines
+EDIT_MODE=steal EDITORS=4
+EDIT_MODE=steal EDITORS=4 EDITING=timer
+EDIT_MODE=steal EDITORS=2 SPORT_EDITORS=3 EDIT_MS=1
+EDIT_MODE=steal EDITORS=3 DISPATCHERS=3 NEWS_PRIORITY=0
+EDIT_MODE=steal EDITORS=3 RUNTIME=coroutines
+EOF
+exit $failed